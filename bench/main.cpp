@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include "cxxopts.hpp"
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <paillier.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace paillier;
+using Clock = std::chrono::steady_clock;
+
+// distinct operands each thread cycles through, so no single value stays in cache
+static constexpr std::size_t operands{16};
+// ciphertexts written and read back by one io round trip
+static constexpr std::size_t io_batch{64};
+
+struct Benchmark
+{
+    std::string name;
+    // work items done by one call of op, e.g. the records of an io round trip
+    std::size_t items;
+    std::function<void(std::size_t)> op;
+};
+
+struct Sample
+{
+    std::string name;
+    mp_bitcnt_t bits;
+    std::size_t items, threads, ops;
+    double seconds;
+    std::vector<double> latencies;
+};
+
+/*
+ * Runs op on the given number of threads, each looping independently until it
+ * has done at least min_ops calls and spent at least min_time seconds. Every
+ * call is timed on its own, throughput is taken over the slowest thread.
+ */
+static Sample measure(const Benchmark &bench, mp_bitcnt_t bits, std::size_t threads, double min_time, std::size_t min_ops)
+{
+    std::vector<std::vector<double>> latencies(threads);
+    std::vector<double> elapsed(threads);
+    std::atomic<std::size_t> ready{0};
+    std::vector<std::thread> workers{};
+
+    for (std::size_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            // start together so the threads actually overlap
+            ready.fetch_add(1);
+            while (ready.load() < threads)
+            {
+                std::this_thread::yield();
+            }
+
+            const Clock::time_point start{Clock::now()};
+            Clock::time_point now{start};
+            for (std::size_t i = 0; i < min_ops || now - start < std::chrono::duration<double>(min_time); ++i)
+            {
+                const Clock::time_point before{Clock::now()};
+                bench.op(t * operands + i);
+                now = Clock::now();
+                latencies[t].push_back(std::chrono::duration<double, std::micro>(now - before).count());
+            }
+            elapsed[t] = std::chrono::duration<double>(now - start).count();
+        });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    Sample sample{bench.name, bits, bench.items, threads, 0, *std::max_element(elapsed.begin(), elapsed.end()), {}};
+    for (const auto &thread : latencies)
+    {
+        sample.latencies.insert(sample.latencies.end(), thread.begin(), thread.end());
+    }
+    sample.ops = sample.latencies.size();
+    std::sort(sample.latencies.begin(), sample.latencies.end());
+    return sample;
+}
+
+/*
+ * Nearest rank percentile of sorted latencies.
+ */
+static double percentile(const std::vector<double> &sorted, double rank)
+{
+    const std::size_t i{static_cast<std::size_t>(rank / 100.0 * sorted.size() + 0.5)};
+    return sorted[std::min(i == 0 ? 0 : i - 1, sorted.size() - 1)];
+}
+
+static std::vector<Benchmark> benchmarks(const mp_bitcnt_t bits)
+{
+    // shared by the closures below, which outlive this call
+    const auto keys = std::make_shared<std::pair<impl::key::Private, impl::key::Public>>(impl::key::gen(bits));
+    const auto ctx = std::make_shared<impl::PublicContext>(keys->second);
+    const auto &[priv, pub] = *keys;
+
+    tools::Random &random{tools::Random::get()};
+    const auto plains = std::make_shared<std::vector<impl::PlainText>>();
+    const auto ciphers = std::make_shared<std::vector<impl::CipherText>>();
+    const auto scalars = std::make_shared<std::vector<mpz_class>>(random.random_n(pub.n, operands));
+    const auto bases = std::make_shared<std::vector<mpz_class>>(random.relatively_prime(pub.n, operands));
+    // the exponents of the randomizer r^n in encrypt(priv), reduced by the orders of the CRT moduli
+    const auto exps = std::make_shared<const std::pair<mpz_class, mpz_class>>(
+        priv.n % (priv.p * (priv.p - 1U)), priv.n % (priv.q * (priv.q - 1U)));
+
+    for (std::size_t i = 0; i < operands; ++i)
+    {
+        plains->push_back({random.random_n(pub.n)});
+        ciphers->push_back(plains->back().encrypt(*ctx));
+    }
+
+    std::vector<impl::CipherText> batch{};
+    for (std::size_t i = 0; i < io_batch; ++i)
+    {
+        batch.push_back((*ciphers)[i % operands]);
+    }
+    const auto records = std::make_shared<const std::vector<impl::CipherText>>(std::move(batch));
+
+    const auto round_trip = [keys, records](io::Format format) {
+        return [keys, records, format](std::size_t) {
+            std::stringstream buffer{};
+            io::write_ciphers(buffer, *records, keys->second, format);
+            if (io::read_ciphers(buffer, keys->second).size() != records->size())
+            {
+                throw std::runtime_error("ciphertext round trip lost records");
+            }
+        };
+    };
+
+    return {
+        {"keygen", 1, [bits](std::size_t) { impl::key::gen(bits); }},
+        {"encrypt", 1, [keys, plains](std::size_t i) { (*plains)[i % operands].encrypt(keys->second); }},
+        {"encrypt_context", 1, [ctx, plains](std::size_t i) { (*plains)[i % operands].encrypt(*ctx); }},
+        {"decrypt", 1, [keys, ciphers](std::size_t i) { (*ciphers)[i % operands].decrypt(keys->first); }},
+        {"add", 1, [ctx, ciphers](std::size_t i) { (*ciphers)[i % operands].add((*ciphers)[(i + 1) % operands], *ctx); }},
+        {"mult", 1, [ctx, ciphers, scalars](std::size_t i) { (*ciphers)[i % operands].mult((*scalars)[i % operands], *ctx); }},
+        {"crt_exponentiation", 1, [keys, bases, exps](std::size_t i) {
+             const impl::key::Private &priv{keys->first};
+             tools::crt_exponentiation((*bases)[i % operands], exps->first, exps->second, priv.p2invq2, priv.p2, priv.q2);
+         }},
+        {"ell", 1, [keys, ciphers](std::size_t i) { impl::key::ell((*ciphers)[i % operands].text, keys->second.n); }},
+        {"io_text", io_batch, round_trip(io::Format::text)},
+        {"io_binary", io_batch, round_trip(io::Format::binary)},
+        {"io_key", 1, [keys](std::size_t) {
+             std::stringstream buffer{};
+             impl::key::Private priv{};
+             io::write_key(buffer, keys->first);
+             io::read_key(buffer, priv);
+         }},
+    };
+}
+
+static void write_json(std::ostream &os, const std::vector<Sample> &samples, double min_time, std::size_t min_ops)
+{
+    os << std::fixed << std::setprecision(3)
+       << "{\n"
+       << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+       << "  \"executor_threads\": " << tools::Executor::get().size() << ",\n"
+       << "  \"min_time\": " << min_time << ",\n"
+       << "  \"min_ops\": " << min_ops << ",\n"
+       << "  \"results\": [";
+
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+        const Sample &s{samples[i]};
+        os << (i == 0 ? "\n" : ",\n")
+           << "    {\"name\": \"" << s.name << "\", \"bits\": " << s.bits << ", \"threads\": " << s.threads
+           << ", \"items\": " << s.items << ", \"ops\": " << s.ops << ", \"seconds\": " << s.seconds
+           << ", \"ops_per_sec\": " << s.ops / s.seconds << ", \"items_per_sec\": " << s.ops * s.items / s.seconds
+           << ", \"latency_us\": {\"min\": " << s.latencies.front() << ", \"p50\": " << percentile(s.latencies, 50)
+           << ", \"p90\": " << percentile(s.latencies, 90) << ", \"p99\": " << percentile(s.latencies, 99)
+           << ", \"max\": " << s.latencies.back() << "}}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+int main(int argc, char **argv)
+{
+    cxxopts::Options options("paillier_bench", "Throughput, latency and thread scaling of the Paillier primitives");
+
+    std::vector<mp_bitcnt_t> sizes{};
+    std::vector<std::string> filter{};
+    std::uint64_t threads = std::max(1U, std::thread::hardware_concurrency()), min_ops = 5ULL, executor = 0ULL;
+    double min_time = 0.5;
+    std::string output{};
+
+    options.add_options()                                                                                                       //
+        ("h, help", "Print help message")                                                                                       //
+        ("k, kbits", "Key size, repeatable (default: 1024, 2048, 3072 and 4096)", cxxopts::value(sizes), "uint64")               //
+        ("b, bench", "Only run the named benchmark, repeatable (default: all)", cxxopts::value(filter), "NAME")                 //
+        ("t, threads", "Largest thread count of the scaling curve (default: hardware threads)", cxxopts::value(threads), "uint64") //
+        ("j, executor", "Executor worker threads (default: hardware threads)", cxxopts::value(executor), "uint64")           //
+        ("min-time", "Minimum seconds per measurement", cxxopts::value(min_time)->default_value("0.5"), "double")            //
+        ("min-ops", "Minimum calls per thread and measurement", cxxopts::value(min_ops)->default_value("5"), "uint64")       //
+        ("o, output", "JSON report (default: stdout)", cxxopts::value(output), "FILE")                                          //
+        ;
+
+    try
+    {
+        options.parse(argc, argv);
+
+        if (options.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            exit(0);
+        }
+    }
+    catch (const cxxopts::OptionException &e)
+    {
+        std::cerr << "error parsing options: " << e.what() << std::endl;
+        exit(1);
+    }
+
+    if (sizes.empty())
+    {
+        sizes = {1024, 2048, 3072, 4096};
+    }
+
+    if (options.count("executor"))
+    {
+        tools::Executor::init(executor);
+    }
+
+    // powers of two up to the requested maximum, which is always included
+    std::vector<std::size_t> counts{};
+    for (std::size_t t = 1; t < threads; t *= 2)
+    {
+        counts.push_back(t);
+    }
+    counts.push_back(std::max<std::size_t>(threads, 1));
+
+    std::vector<Sample> samples{};
+    for (const mp_bitcnt_t bits : sizes)
+    {
+        for (const auto &bench : benchmarks(bits))
+        {
+            if (!filter.empty() && std::find(filter.begin(), filter.end(), bench.name) == filter.end())
+            {
+                continue;
+            }
+
+            for (const std::size_t count : counts)
+            {
+                samples.push_back(measure(bench, bits, count, min_time, min_ops));
+                const Sample &s{samples.back()};
+                std::cerr << std::fixed << std::setprecision(1)
+                          << std::setw(20) << std::left << s.name << std::right
+                          << std::setw(6) << s.bits << " bits " << std::setw(3) << s.threads << " threads "
+                          << std::setw(12) << s.ops / s.seconds << " ops/s  p50 " << std::setw(10) << percentile(s.latencies, 50)
+                          << " us  p99 " << std::setw(10) << percentile(s.latencies, 99) << " us" << std::endl;
+            }
+        }
+    }
+
+    if (output.empty())
+    {
+        write_json(std::cout, samples, min_time, min_ops);
+    }
+    else
+    {
+        std::fstream report(output, report.out);
+        write_json(report, samples, min_time, min_ops);
+    }
+
+    return 0;
+}
@@ -4,8 +4,10 @@
 #include <fstream>
 #include <future>
 #include <iostream>
+#include <iterator>
 #include <paillier.hpp>
 #include <string>
+#include <thread>
 #include <vector>
 
 template <typename T>
@@ -19,13 +21,14 @@ int main(int argc, char **argv)
 {
     cxxopts::Options options("secure_dot_product", "Secure dot product using Paillier homomorphic encryption");
 
-    std::uint64_t k = 0ULL;
+    std::uint64_t k = 0ULL, threads = 0ULL;
     std::string eu, ev, priv, pub, result, seed, u, v;
 
     options.add_options()                                              //
         ("h, help", "Print help message")                              //
         ("pk", "Public key (required)", cxxopts::value(pub), "FILE")   //
         ("sk", "Private key (required)", cxxopts::value(priv), "FILE") //
+        ("j, threads", "Worker threads (default: hardware threads)", cxxopts::value(threads), "uint64") //
         ;
     options.add_options("key generation")                                          //
         ("seed", "Seed key generation with k,p,q,g", cxxopts::value(seed), "FILE") //
@@ -65,6 +68,11 @@ int main(int argc, char **argv)
 
     using namespace paillier;
 
+    if (options.count("threads"))
+    {
+        tools::Executor::init(threads);
+    }
+
     if (options.count("pk") && options.count("sk"))
     {
         if (options.count("seed"))
@@ -110,20 +118,11 @@ int main(int argc, char **argv)
         exit(1);
     }
 
-    const auto f_encrypt = [=](const impl::PlainText &p) {
-        static const auto encrypt = [pub_key](const impl::PlainText &p) { return p.encrypt(pub_key); };
-        return std::async(encrypt, p);
-    };
+    const impl::PublicContext ctx{pub_key};
 
-    const auto f_mult = [=](const std::shared_future<impl::CipherText> &f_c, const impl::PlainText &p) {
-        static const auto mult = [pub_key](const impl::CipherText &c, const impl::PlainText &p) {
-            return c.mult(p.text, pub_key);
-        };
-        return std::async(mult, f_c.get(), p);
-    };
-
-    const auto add = [pub_key](const impl::CipherText &acc, const std::shared_future<impl::CipherText> &f_c) {
-        return acc.add(f_c.get(), pub_key);
+    const auto f_encrypt = [&ctx](const impl::PlainText &p) {
+        static const auto encrypt = [&ctx](const impl::PlainText &p) { return p.encrypt(ctx); };
+        return tools::async(encrypt, p);
     };
 
     const auto write = [](io::ssv out, const std::vector<std::shared_future<impl::CipherText>> &v_f_c) {
@@ -134,7 +133,7 @@ int main(int argc, char **argv)
         }
     };
 
-    std::vector<std::shared_future<impl::CipherText>> f_eu_vec, f_ev_vec, f_ev_u_vec;
+    std::vector<std::shared_future<impl::CipherText>> f_eu_vec, f_ev_vec;
 
     std::transform(u_vec.begin(), u_vec.end(), std::back_inserter(f_eu_vec), f_encrypt);
     std::transform(v_vec.begin(), v_vec.end(), std::back_inserter(f_ev_vec), f_encrypt);
@@ -142,9 +141,13 @@ int main(int argc, char **argv)
     std::thread(write, eu, f_eu_vec).detach();
     std::thread(write, ev, f_ev_vec).detach();
 
-    std::transform(f_ev_vec.begin(), f_ev_vec.end(), u_vec.begin(), std::back_inserter(f_ev_u_vec), f_mult);
+    std::vector<impl::CipherText> ev_vec{};
+    std::vector<mpz_class> u_scalars{};
+
+    std::transform(f_ev_vec.begin(), f_ev_vec.end(), std::back_inserter(ev_vec), [](const auto &f_c) { return tools::await(f_c); });
+    std::transform(u_vec.begin(), u_vec.end(), std::back_inserter(u_scalars), [](const impl::PlainText &p) { return p.text; });
 
-    const auto e_dot_prod = std::accumulate(f_ev_u_vec.begin(), f_ev_u_vec.end(), impl::PlainText(0).encrypt(pub_key), add);
+    const auto e_dot_prod = impl::dot(ev_vec, u_scalars, ctx);
     const auto dot_prod = e_dot_prod.decrypt(priv_key);
 
     {
@@ -1,8 +1,17 @@
 #ifndef PAILLIER_HPP
 #define PAILLIER_HPP
 
+#include <accumulator.hpp>
+#include <arena.hpp>
+#include <batch.hpp>
+#include <encoding.hpp>
+#include <executor.hpp>
 #include <impl.hpp>
 #include <io.hpp>
+#include <metrics.hpp>
+#include <packing.hpp>
+#include <pool.hpp>
+#include <store.hpp>
 #include <tools.hpp>
 
 #endif // PAILLIER_HPP
@@ -0,0 +1,33 @@
+#ifndef PAILLIER_ACCUMULATOR_HPP
+#define PAILLIER_ACCUMULATOR_HPP
+
+#include <gmpxx.h>
+#include <impl.hpp>
+#include <vector>
+
+namespace paillier::impl
+{
+
+class Accumulator
+{
+  mpz_class n2;
+  mp_size_t limbs;
+  mp_limb_t ninv;
+  // running product and the number of factors R^-1 it carries
+  std::vector<mp_limb_t> value, product, padded, quotient;
+  mpz_class shifts;
+
+  void reduce(const mp_limb_t *operand);
+
+public:
+  explicit Accumulator(const PublicContext &ctx);
+
+  void add(const CipherText &cipher);
+  void add(mpz_srcptr cipher);
+  void mult(const mpz_class &scalar);
+  CipherText get() const;
+};
+
+} // paillier::impl
+
+#endif // PAILLIER_ACCUMULATOR_HPP
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include "arena.hpp"
+#include "batch.hpp"
+#include <cstdlib>
+#include "executor.hpp"
+#include <new>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace paillier::impl
+{
+
+static constexpr std::size_t cache_line{64}, huge_page{std::size_t{1} << 21};
+
+static mp_limb_t *allocate(const std::size_t limbs, const bool huge_pages)
+{
+    const std::size_t alignment{huge_pages ? huge_page : cache_line};
+    const std::size_t bytes{((limbs * sizeof(mp_limb_t) + alignment - 1) / alignment) * alignment};
+    void *memory{std::aligned_alloc(alignment, bytes)};
+
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (huge_pages)
+    {
+        madvise(memory, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    return static_cast<mp_limb_t *>(memory);
+}
+
+void CipherTextBatch::Release::operator()(mp_limb_t *limbs) const
+{
+    std::free(limbs);
+}
+
+/*
+ * Structure-of-arrays storage for ciphertexts of one key: every ciphertext is a
+ * row of exactly as many limbs as n^2, zero padded, in one aligned arena.
+ * Huge pages are requested with madvise where available.
+ */
+CipherTextBatch::CipherTextBatch(const PublicContext &ctx, std::size_t capacity, bool huge_pages)
+    : stride(ctx.limbs),
+      count(0),
+      capacity(0),
+      huge_pages(huge_pages)
+{
+    reserve(capacity);
+}
+
+CipherTextBatch::CipherTextBatch(const std::vector<CipherText> &ciphers, const PublicContext &ctx, bool huge_pages)
+    : CipherTextBatch(ctx, ciphers.size(), huge_pages)
+{
+    count = ciphers.size();
+    tools::parallel_for(count, [&](const std::size_t first, const std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+        {
+            store(row(i), ciphers[i].text.get_mpz_t(), ctx);
+        }
+    });
+}
+
+void CipherTextBatch::reserve(std::size_t rows)
+{
+    if (rows <= capacity)
+    {
+        return;
+    }
+
+    std::unique_ptr<mp_limb_t[], Release> grown{allocate(rows * stride, huge_pages)};
+    if (count > 0)
+    {
+        std::copy_n(arena.get(), count * stride, grown.get());
+    }
+    arena = std::move(grown);
+    capacity = rows;
+}
+
+/*
+ * Writes a value reduced mod n^2 into a row, zero padding the high limbs.
+ */
+void CipherTextBatch::store(mp_limb_t *row, mpz_srcptr value, const PublicContext &ctx)
+{
+    mpz_class reduced{};
+    if (mpz_sgn(value) < 0 || mpz_cmp(value, ctx.n2.get_mpz_t()) >= 0)
+    {
+        mpz_mod(reduced.get_mpz_t(), value, ctx.n2.get_mpz_t());
+        value = reduced.get_mpz_t();
+    }
+
+    const mp_size_t size{static_cast<mp_size_t>(mpz_size(value))};
+    std::copy_n(mpz_limbs_read(value), size, row);
+    std::fill(row + size, row + stride, mp_limb_t{0});
+}
+
+void CipherTextBatch::push_back(const CipherText &cipher, const PublicContext &ctx)
+{
+    if (count == capacity)
+    {
+        reserve(capacity == 0 ? 16 : 2 * capacity);
+    }
+    store(row(count), cipher.text.get_mpz_t(), ctx);
+    ++count;
+}
+
+void CipherTextBatch::set(std::size_t i, const CipherText &cipher, const PublicContext &ctx)
+{
+    store(row(i), cipher.text.get_mpz_t(), ctx);
+}
+
+/*
+ * Row-wise homomorphic addition: row_i = row_i * other_i mod n^2.
+ * Works on the limbs directly with mpn_mul_n and mpn_tdiv_qr, using one scratch
+ * buffer per chunk of rows.
+ */
+void CipherTextBatch::add(const CipherTextBatch &other, const PublicContext &ctx)
+{
+    if (other.count != count || other.stride != stride)
+    {
+        throw std::runtime_error("ciphertext batches differ in size or key");
+    }
+
+    const mp_limb_t *n2{mpz_limbs_read(ctx.n2.get_mpz_t())};
+
+    tools::parallel_for(count, [&](const std::size_t first, const std::size_t last) {
+        std::vector<mp_limb_t> product(2 * stride), quotient(stride + 1);
+        for (std::size_t i = first; i < last; ++i)
+        {
+            mpn_mul_n(product.data(), row(i), other.row(i), stride);
+            mpn_tdiv_qr(quotient.data(), row(i), 0, product.data(), 2 * stride, n2, stride);
+        }
+    });
+}
+
+/*
+ * Row-wise homomorphic multiplication by a constant: row_i = row_i^constant mod n^2.
+ */
+void CipherTextBatch::mult(const mpz_class &constant, const PublicContext &ctx)
+{
+    tools::parallel_for(count, [&](const std::size_t first, const std::size_t last) {
+        mpz_class result{};
+        for (std::size_t i = first; i < last; ++i)
+        {
+            mpz_powm(result.get_mpz_t(), (*this)[i].get_mpz_t(), constant.get_mpz_t(), ctx.n2.get_mpz_t());
+            store(row(i), result.get_mpz_t(), ctx);
+        }
+    });
+}
+
+/*
+ * Decrypts every row, scheduling the half exponentiations of all rows as separate tasks.
+ */
+std::vector<PlainText> CipherTextBatch::decrypt(const key::Private &priv) const
+{
+    return decrypt_batch(count, [this](std::size_t i) { return mpz_class((*this)[i].get_mpz_t()); }, priv);
+}
+
+} // paillier::impl
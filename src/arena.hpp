@@ -0,0 +1,61 @@
+#ifndef PAILLIER_ARENA_HPP
+#define PAILLIER_ARENA_HPP
+
+#include <gmpxx.h>
+#include <impl.hpp>
+#include <memory>
+#include <vector>
+
+namespace paillier::impl
+{
+
+class CipherTextView
+{
+  mpz_t value;
+
+public:
+  CipherTextView(const mp_limb_t *limbs, mp_size_t size)
+  {
+    mpz_roinit_n(value, limbs, size);
+  }
+
+  mpz_srcptr get_mpz_t() const { return value; }
+  operator CipherText() const { return {mpz_class(value)}; }
+};
+
+class CipherTextBatch
+{
+  struct Release
+  {
+    void operator()(mp_limb_t *limbs) const;
+  };
+
+  std::unique_ptr<mp_limb_t[], Release> arena;
+  mp_size_t stride;
+  std::size_t count, capacity;
+  bool huge_pages;
+
+  void store(mp_limb_t *row, mpz_srcptr value, const PublicContext &ctx);
+
+public:
+  explicit CipherTextBatch(const PublicContext &ctx, std::size_t capacity = 0, bool huge_pages = false);
+  CipherTextBatch(const std::vector<CipherText> &ciphers, const PublicContext &ctx, bool huge_pages = false);
+
+  std::size_t size() const { return count; }
+  mp_size_t width() const { return stride; }
+  mp_limb_t *row(std::size_t i) { return arena.get() + i * stride; }
+  const mp_limb_t *row(std::size_t i) const { return arena.get() + i * stride; }
+  CipherTextView operator[](std::size_t i) const { return {row(i), stride}; }
+
+  void reserve(std::size_t rows);
+  void push_back(const CipherText &cipher, const PublicContext &ctx);
+  void set(std::size_t i, const CipherText &cipher, const PublicContext &ctx);
+
+  void add(const CipherTextBatch &other, const PublicContext &ctx);
+  void mult(const mpz_class &constant, const PublicContext &ctx);
+  std::vector<PlainText> decrypt(const key::Private &priv) const;
+};
+
+} // paillier::impl
+
+#endif // PAILLIER_ARENA_HPP
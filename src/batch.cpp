@@ -0,0 +1,201 @@
+#include "batch.hpp"
+#include <algorithm>
+#include <exception>
+#include "executor.hpp"
+#include <future>
+#include "metrics.hpp"
+#include <mutex>
+#include <stdexcept>
+
+namespace paillier::impl
+{
+
+/*
+ * Encrypts many plaintexts with one public key context.
+ *
+ * The batch is cut into chunks spread over the executor. Each chunk draws the
+ * random values of all its encryptions in one call, then computes g^m*r^n mod n^2
+ * for its elements.
+ */
+std::vector<CipherText> encrypt_batch(const std::vector<PlainText> &plains, const PublicContext &ctx)
+{
+    std::vector<CipherText> ciphers(plains.size());
+
+    tools::parallel_for(plains.size(), [&](const std::size_t first, const std::size_t last) {
+        const std::vector<mpz_class> nonces{ctx.nonces(last - first)};
+        for (std::size_t i = first; i < last; ++i)
+        {
+            // for s = 1 the plaintext n encrypts to 0 as in PlainText::encrypt, for s > 1 it is an ordinary value
+            if (ctx.pub.s == 1 && plains[i].text == ctx.pub.n)
+            {
+                continue;
+            }
+            const tools::OperationTimer timer{tools::Operation::encrypt};
+            mpz_class &c{ciphers[i].text};
+            c = ctx.randomizer(nonces[i - first]);
+            c *= ctx.power(plains[i].text);
+            mpz_mod(c.get_mpz_t(), c.get_mpz_t(), ctx.n2.get_mpz_t());
+        }
+    });
+
+    return ciphers;
+}
+
+/*
+ * Decrypts many ciphertexts with one private key.
+ *
+ * Every half exponentiation (mod p^2 and mod q^2) of every ciphertext is scheduled
+ * as its own task, so the whole batch spreads over all workers instead of being
+ * limited to the two-way split of a single decryption. The halves are then
+ * recombined in place in input order.
+ */
+std::vector<PlainText> decrypt_batch(const std::size_t count,
+                                     const std::function<mpz_class(std::size_t)> &text,
+                                     const key::Private &priv)
+{
+    std::vector<PlainText> plains(count);
+    std::vector<mpz_class> halves_q(count);
+    std::vector<std::future<void>> tasks{};
+    tasks.reserve(2 * count);
+
+    // a decryption is recorded with the cycles of both halves, which run on different threads
+    tools::Metrics &metrics{tools::Metrics::get()};
+    std::vector<std::uint64_t> cycles_p(count), cycles_q(count);
+    const auto timed = [&metrics](std::uint64_t &cycles, auto &&half) {
+        const std::uint64_t start{metrics.enabled() ? tools::Metrics::cycles() : 0};
+        half();
+        cycles = start != 0 ? tools::Metrics::cycles() - start : 0;
+    };
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        tasks.push_back(tools::async([&, i]() { timed(cycles_p[i], [&]() { plains[i].text = priv.half_p(text(i)); }); }));
+        tasks.push_back(tools::async([&, i]() { timed(cycles_q[i], [&]() { halves_q[i] = priv.half_q(text(i)); }); }));
+    }
+
+    // every task refers to the locals above, so all of them are awaited before a failure is rethrown
+    std::exception_ptr failure{};
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        for (std::size_t half = 2 * i; half < 2 * i + 2; ++half)
+        {
+            try
+            {
+                tools::await(tasks[half]);
+            }
+            catch (...)
+            {
+                if (!failure)
+                {
+                    failure = std::current_exception();
+                }
+            }
+        }
+        if (failure)
+        {
+            continue;
+        }
+
+        std::uint64_t combined{0};
+        timed(combined, [&]() { plains[i].text = priv.combine(plains[i].text, halves_q[i]); });
+        if (cycles_p[i] != 0 && cycles_q[i] != 0)
+        {
+            metrics.record(tools::Operation::decrypt, cycles_p[i] + cycles_q[i] + combined);
+        }
+    }
+
+    if (failure)
+    {
+        std::rethrow_exception(failure);
+    }
+    return plains;
+}
+
+std::vector<PlainText> decrypt_batch(const std::vector<CipherText> &ciphers, const key::Private &priv)
+{
+    return decrypt_batch(ciphers.size(), [&ciphers](std::size_t i) { return ciphers[i].text; }, priv);
+}
+
+/*
+ * Homomorphic dot product of encrypted and plaintext vectors:
+ * prod c_i^{u_i} mod n^(s+1) decrypts to sum m_i*u_i mod n^s.
+ *
+ * All terms are evaluated as one multi-exponentiation sharing its squarings.
+ * Scalars are reduced mod n^s as in mult_plain, so negative ones are accepted.
+ */
+CipherText dot(const std::vector<CipherText> &ciphers, const std::vector<mpz_class> &scalars, const PublicContext &ctx)
+{
+    if (ciphers.size() != scalars.size())
+    {
+        throw std::runtime_error("dot product of vectors of different lengths");
+    }
+
+    std::vector<mpz_class> reduced(scalars.size());
+    std::vector<mpz_srcptr> bases(ciphers.size()), exps(scalars.size());
+    for (std::size_t i = 0; i < scalars.size(); ++i)
+    {
+        mpz_mod(reduced[i].get_mpz_t(), scalars[i].get_mpz_t(), ctx.ns.get_mpz_t());
+    }
+
+    std::transform(ciphers.begin(), ciphers.end(), bases.begin(), [](const CipherText &c) { return c.text.get_mpz_t(); });
+    std::transform(reduced.begin(), reduced.end(), exps.begin(), [](const mpz_class &u) { return u.get_mpz_t(); });
+
+    return {tools::multi_exponentiation(bases, exps, ctx.n2)};
+}
+
+/*
+ * Homomorphic sum of many ciphertexts: prod c_i mod n^(s+1) decrypts to sum m_i mod n^s.
+ *
+ * Every chunk of the executor multiplies its ciphertexts into a partial product,
+ * and the partial products are then combined pairwise as a tree. Deferring the
+ * reductions to larger products measured slower than reducing each product
+ * mod n^2 right away at 2048 and 4096 bit keys, so every step is reduced.
+ */
+CipherText sum(const CipherText *ciphers, const std::size_t count, const PublicContext &ctx)
+{
+    std::mutex lock{};
+    std::vector<mpz_class> level{};
+
+    tools::parallel_for(count, [&](const std::size_t first, const std::size_t last) {
+        mpz_class product{ciphers[first].text};
+        for (std::size_t i = first + 1; i < last; ++i)
+        {
+            mpz_mul(product.get_mpz_t(), product.get_mpz_t(), ciphers[i].text.get_mpz_t());
+            mpz_mod(product.get_mpz_t(), product.get_mpz_t(), ctx.n2.get_mpz_t());
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        level.push_back(std::move(product));
+    });
+
+    if (level.empty())
+    {
+        // 1 = g^0 * 1^n is the trivial encryption of 0
+        return {1U};
+    }
+
+    while (level.size() > 1)
+    {
+        const std::size_t half{level.size() / 2}, odd{level.size() % 2};
+        for (std::size_t i = 0; i < half; ++i)
+        {
+            mpz_mul(level[i].get_mpz_t(), level[2 * i].get_mpz_t(), level[2 * i + 1].get_mpz_t());
+            mpz_mod(level[i].get_mpz_t(), level[i].get_mpz_t(), ctx.n2.get_mpz_t());
+        }
+        if (odd)
+        {
+            level[half] = std::move(level.back());
+        }
+        level.resize(half + odd);
+    }
+
+    mpz_mod(level.front().get_mpz_t(), level.front().get_mpz_t(), ctx.n2.get_mpz_t());
+    return {level.front()};
+}
+
+CipherText sum(const std::vector<CipherText> &ciphers, const PublicContext &ctx)
+{
+    return sum(ciphers.data(), ciphers.size(), ctx);
+}
+
+} // paillier::impl
@@ -0,0 +1,23 @@
+#ifndef PAILLIER_BATCH_HPP
+#define PAILLIER_BATCH_HPP
+
+#include <functional>
+#include <gmpxx.h>
+#include <impl.hpp>
+#include <vector>
+
+namespace paillier::impl
+{
+
+std::vector<CipherText> encrypt_batch(const std::vector<PlainText> &plains, const PublicContext &ctx);
+std::vector<PlainText> decrypt_batch(const std::size_t count,
+                                     const std::function<mpz_class(std::size_t)> &text,
+                                     const key::Private &priv);
+std::vector<PlainText> decrypt_batch(const std::vector<CipherText> &ciphers, const key::Private &priv);
+CipherText dot(const std::vector<CipherText> &ciphers, const std::vector<mpz_class> &scalars, const PublicContext &ctx);
+CipherText sum(const CipherText *ciphers, const std::size_t count, const PublicContext &ctx);
+CipherText sum(const std::vector<CipherText> &ciphers, const PublicContext &ctx);
+
+} // paillier::impl
+
+#endif // PAILLIER_BATCH_HPP
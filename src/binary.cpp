@@ -0,0 +1,390 @@
+#include <algorithm>
+#include "io.hpp"
+#include "metrics.hpp"
+#include <stdexcept>
+
+namespace paillier::io
+{
+
+static constexpr std::array<std::uint8_t, 4> magic{'P', 'G', 'M', 'P'};
+
+template <typename T>
+static void put(std::uint8_t *out, const T value)
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+    {
+        out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+}
+
+template <typename T>
+static T take(const std::uint8_t *in)
+{
+    T value{0};
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+    {
+        value |= static_cast<T>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+/*
+ * Binary header, all fields little-endian:
+ *
+ * magic "PGMP" | version u16 | kind u16 | key fingerprint u64 | limbs u32 | reserved u32 | count u64
+ *
+ * It is followed by count values of limbs 64-bit little-endian words each.
+ */
+std::array<std::uint8_t, Header::size> Header::serialize() const
+{
+    std::array<std::uint8_t, size> bytes{};
+    std::copy(magic.begin(), magic.end(), bytes.begin());
+    put(&bytes[4], version);
+    put(&bytes[6], static_cast<std::uint16_t>(kind));
+    put(&bytes[8], fingerprint);
+    put(&bytes[16], limbs);
+    put(&bytes[24], count);
+    return bytes;
+}
+
+Header Header::parse(const std::uint8_t *bytes)
+{
+    if (!std::equal(magic.begin(), magic.end(), bytes))
+    {
+        throw std::runtime_error("not a binary paillier file");
+    }
+
+    Header header{take<std::uint16_t>(&bytes[4]),
+                  static_cast<Kind>(take<std::uint16_t>(&bytes[6])),
+                  take<std::uint64_t>(&bytes[8]),
+                  take<std::uint32_t>(&bytes[16]),
+                  take<std::uint64_t>(&bytes[24])};
+
+    if (header.version != current)
+    {
+        throw std::runtime_error("unsupported binary paillier file version");
+    }
+    return header;
+}
+
+/*
+ * FNV-1a over the little-endian bytes of n identifies the key a file belongs to.
+ */
+std::uint64_t fingerprint(const mpz_class &n)
+{
+    const std::uint32_t width{limbs(n)};
+    std::vector<std::uint8_t> bytes(8 * width);
+    export_limbs(bytes.data(), n, width);
+
+    std::uint64_t hash{0xcbf29ce484222325ULL};
+    for (const std::uint8_t byte : bytes)
+    {
+        hash = (hash ^ byte) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/*
+ * Number of 64-bit words needed for a value.
+ */
+std::uint32_t limbs(const mpz_class &value)
+{
+    return static_cast<std::uint32_t>((mpz_sizeinbase(value.get_mpz_t(), 2) + 63) / 64);
+}
+
+/*
+ * Text files start with digits or whitespace, binary files with the magic.
+ */
+Format detect(std::istream &is)
+{
+    return is.peek() == magic[0] ? Format::binary : Format::text;
+}
+
+void export_limbs(std::uint8_t *out, const mpz_class &value, std::uint32_t limbs)
+{
+    if (value < 0 || io::limbs(value) > limbs)
+    {
+        throw std::runtime_error("value does not fit the binary record");
+    }
+
+    std::size_t written{0};
+    std::fill_n(out, 8 * std::size_t{limbs}, std::uint8_t{0});
+    mpz_export(out, &written, -1, 8, -1, 0, value.get_mpz_t());
+}
+
+void import_limbs(mpz_class &value, const std::uint8_t *in, std::uint32_t limbs)
+{
+    mpz_import(value.get_mpz_t(), limbs, -1, 8, -1, 0, in);
+}
+
+// widest record accepted from a file, 2^18 bits is far beyond any practical key
+static constexpr std::uint32_t max_limbs{4096};
+// records reserved up front, larger files grow the vector as their records arrive
+static constexpr std::uint64_t reserved_records{1024};
+
+/*
+ * Reads and checks the header of a binary file holding values of the given kind.
+ * The record width is bounded here, the count is left to the readers.
+ */
+Header read_header(std::istream &is, const Kind kind)
+{
+    std::array<std::uint8_t, Header::size> bytes{};
+    if (!is.read(reinterpret_cast<char *>(bytes.data()), bytes.size()))
+    {
+        throw std::runtime_error("truncated binary paillier header");
+    }
+
+    const Header header{Header::parse(bytes.data())};
+    if (header.kind != kind)
+    {
+        throw std::runtime_error("binary paillier file holds a different kind of value");
+    }
+    if (header.limbs == 0 || header.limbs > max_limbs)
+    {
+        throw std::runtime_error("binary paillier record width out of range");
+    }
+    return header;
+}
+
+/*
+ * The count comes from the file, so memory is only committed for records
+ * that were actually read.
+ */
+static std::vector<mpz_class> read_values(std::istream &is, const Header &header)
+{
+    std::vector<mpz_class> values{};
+    std::vector<std::uint8_t> record(8 * std::size_t{header.limbs});
+    values.reserve(std::min(header.count, reserved_records));
+
+    for (std::uint64_t i = 0; i < header.count; ++i)
+    {
+        if (!is.read(reinterpret_cast<char *>(record.data()), record.size()))
+        {
+            throw std::runtime_error("truncated binary paillier file");
+        }
+        import_limbs(values.emplace_back(), record.data(), header.limbs);
+    }
+    return values;
+}
+
+static std::uint32_t widest(const std::vector<const mpz_class *> &values)
+{
+    std::uint32_t width{1};
+    for (const mpz_class *value : values)
+    {
+        width = std::max(width, limbs(*value));
+    }
+    return width;
+}
+
+static void write_values(std::ostream &os, const Kind kind, const std::uint64_t fingerprint, const std::uint32_t width, const std::vector<const mpz_class *> &values)
+{
+    const auto header = Header{Header::current, kind, fingerprint, width, values.size()}.serialize();
+    os.write(reinterpret_cast<const char *>(header.data()), header.size());
+
+    std::vector<std::uint8_t> record(8 * std::size_t{width});
+    for (const mpz_class *value : values)
+    {
+        export_limbs(record.data(), *value, width);
+        os.write(reinterpret_cast<const char *>(record.data()), record.size());
+    }
+}
+
+static std::vector<impl::CipherText> read_records(std::istream &is, const Header &header)
+{
+    std::vector<impl::CipherText> ciphers{};
+    for (auto &value : read_values(is, header))
+    {
+        ciphers.emplace_back(std::move(value));
+    }
+    return ciphers;
+}
+
+/*
+ * Reads every ciphertext of a file in either format.
+ */
+std::vector<impl::CipherText> read_ciphers(std::istream &is)
+{
+    const tools::StreamTimer timer{tools::Operation::io_read, is, std::ios::in};
+
+    if (detect(is) == Format::text)
+    {
+        std::vector<impl::CipherText> ciphers{};
+        impl::CipherText c{};
+        while (is >> c)
+        {
+            ciphers.push_back(c);
+        }
+        return ciphers;
+    }
+
+    return read_records(is, read_header(is, Kind::ciphers));
+}
+
+/*
+ * Same as above, but binary files must carry the fingerprint of the given key.
+ * The header is read once and checked before any record, so this works on
+ * streams that cannot seek, like pipes.
+ */
+std::vector<impl::CipherText> read_ciphers(std::istream &is, const impl::key::Public &pub)
+{
+    if (detect(is) == Format::text)
+    {
+        return read_ciphers(is);
+    }
+
+    const tools::StreamTimer timer{tools::Operation::io_read, is, std::ios::in};
+    const Header header{read_header(is, Kind::ciphers)};
+    if (header.fingerprint != fingerprint(pub.n))
+    {
+        throw std::runtime_error("ciphertexts were written for a different key");
+    }
+    if (header.limbs > limbs(pub.modulus()))
+    {
+        throw std::runtime_error("ciphertext records are wider than the ciphertexts of this key");
+    }
+    return read_records(is, header);
+}
+
+/*
+ * Binary public keys hold k, n, g, h_s when present (zero if only s follows) and the degree s when it is not 1.
+ * A persisted comb table of g follows s as its fields. The comb table of h_s is rebuilt on load.
+ */
+void read_key(std::istream &is, impl::key::Public &pub)
+{
+    const tools::StreamTimer timer{tools::Operation::io_read, is, std::ios::in};
+    if (detect(is) == Format::text)
+    {
+        is >> pub;
+        return;
+    }
+
+    const std::vector<mpz_class> values{read_values(is, read_header(is, Kind::public_key))};
+    if (values.size() < 3)
+    {
+        throw std::runtime_error("binary public key is missing fields");
+    }
+
+    pub = impl::key::Public{values[0].get_ui(), values[1], values[2]};
+    if (values.size() > 3 && values[3] != 0U)
+    {
+        pub.hs = values[3];
+    }
+    if (values.size() > 4)
+    {
+        pub.s = static_cast<unsigned>(values[4].get_ui());
+    }
+    if (values.size() > 5)
+    {
+        pub.g_table = std::make_shared<tools::Comb>(tools::Comb::from_fields({values.begin() + 5, values.end()}));
+    }
+    if (pub.hs != 0U)
+    {
+        pub.hs_table = std::make_shared<tools::Comb>(pub.hs, pub.modulus(), impl::key::short_exponent_bits(pub.k));
+    }
+}
+
+/*
+ * Binary private keys hold the legacy fields followed by the crt section when present,
+ * then the degree s when it is not 1.
+ */
+void read_key(std::istream &is, impl::key::Private &priv)
+{
+    const tools::StreamTimer timer{tools::Operation::io_read, is, std::ios::in};
+    if (detect(is) == Format::text)
+    {
+        is >> priv;
+        return;
+    }
+
+    const std::vector<mpz_class> values{read_values(is, read_header(is, Kind::private_key))};
+    if (values.size() < 7)
+    {
+        throw std::runtime_error("binary private key is missing fields");
+    }
+
+    priv = impl::key::Private{values[0].get_ui(), values[1], values[2], values[3], values[4], values[5], values[6]};
+    if (values.size() >= 12)
+    {
+        priv.p = values[7];
+        priv.q = values[8];
+        priv.pinvq = values[9];
+        priv.hp = values[10];
+        priv.hq = values[11];
+    }
+    if (values.size() > 12)
+    {
+        priv.s = static_cast<unsigned>(values[12].get_ui());
+    }
+}
+
+void write_ciphers(std::ostream &os, const std::vector<impl::CipherText> &ciphers, const impl::key::Public &pub, Format format)
+{
+    const tools::StreamTimer timer{tools::Operation::io_write, os, std::ios::out};
+    if (format == Format::text)
+    {
+        for (const auto &c : ciphers)
+        {
+            os << c << "\n";
+        }
+        return;
+    }
+
+    std::vector<const mpz_class *> values(ciphers.size());
+    std::transform(ciphers.begin(), ciphers.end(), values.begin(), [](const impl::CipherText &c) { return &c.text; });
+
+    // fixed record width: every ciphertext takes as many words as n^2
+    const std::uint32_t width{std::max(limbs(pub.modulus()), widest(values))};
+    write_values(os, Kind::ciphers, fingerprint(pub.n), width, values);
+}
+
+void write_key(std::ostream &os, const impl::key::Public &pub, Format format)
+{
+    const tools::StreamTimer timer{tools::Operation::io_write, os, std::ios::out};
+    if (format == Format::text)
+    {
+        os << pub;
+        return;
+    }
+
+    const mpz_class k{static_cast<unsigned long>(pub.k)}, s{pub.s};
+    const std::vector<mpz_class> table{pub.g_table ? pub.g_table->fields() : std::vector<mpz_class>{}};
+    std::vector<const mpz_class *> values{&k, &pub.n, &pub.g};
+    if (pub.hs != 0U || pub.s != 1 || !table.empty())
+    {
+        values.push_back(&pub.hs);
+    }
+    if (pub.s != 1 || !table.empty())
+    {
+        values.push_back(&s);
+    }
+    for (const auto &field : table)
+    {
+        values.push_back(&field);
+    }
+    write_values(os, Kind::public_key, fingerprint(pub.n), widest(values), values);
+}
+
+void write_key(std::ostream &os, const impl::key::Private &priv, Format format)
+{
+    const tools::StreamTimer timer{tools::Operation::io_write, os, std::ios::out};
+    if (format == Format::text)
+    {
+        os << priv;
+        return;
+    }
+
+    const mpz_class k{static_cast<unsigned long>(priv.k)}, s{priv.s};
+    std::vector<const mpz_class *> values{&k, &priv.lambda, &priv.mu, &priv.n, &priv.p2, &priv.p2invq2, &priv.q2};
+    if (priv.hp != 0U)
+    {
+        values.insert(values.end(), {&priv.p, &priv.q, &priv.pinvq, &priv.hp, &priv.hq});
+    }
+    if (priv.s != 1)
+    {
+        values.push_back(&s);
+    }
+    write_values(os, Kind::private_key, fingerprint(priv.n), widest(values), values);
+}
+
+} // paillier::io
@@ -0,0 +1,264 @@
+#include <algorithm>
+#include "batch.hpp"
+#include <cmath>
+#include "encoding.hpp"
+#include <map>
+#include <stdexcept>
+
+namespace paillier::impl
+{
+
+/*
+ * Fixed point numbers over the plaintext space: a real value x is held as the
+ * integer mantissa m = round(x / base^e) at exponent e. Mantissas are signed,
+ * negative ones are stored as n^s + m, so every |m| < n^s/2 round trips.
+ * Values encrypted without an explicit exponent use the given precision.
+ */
+FixedPointEncoder::FixedPointEncoder(const key::Public &pub, unsigned base, int precision)
+    : ns(pub.modulus() / pub.n),
+      base(base),
+      precision(precision)
+{
+    if (base < 2)
+    {
+        throw std::runtime_error("fixed point base must be at least 2");
+    }
+}
+
+/*
+ * base^steps for steps >= 0.
+ */
+mpz_class FixedPointEncoder::scale(int steps) const
+{
+    mpz_class result{};
+    mpz_ui_pow_ui(result.get_mpz_t(), base, static_cast<unsigned long>(steps));
+    return result;
+}
+
+/*
+ * Signed mantissa of value at the given exponent, rounded to nearest.
+ * Doubles convert to rationals exactly, so only the final rounding loses precision.
+ */
+mpz_class FixedPointEncoder::mantissa(double value, int exponent) const
+{
+    if (!std::isfinite(value))
+    {
+        throw std::runtime_error("only finite values can be encoded");
+    }
+
+    mpq_class scaled{value};
+    if (exponent < 0)
+    {
+        scaled *= scale(-exponent);
+    }
+    else
+    {
+        scaled /= scale(exponent);
+    }
+    scaled += mpq_class{1, 2};
+
+    mpz_class result{};
+    mpz_fdiv_q(result.get_mpz_t(), scaled.get_num_mpz_t(), scaled.get_den_mpz_t());
+    if (2 * abs(result) >= ns)
+    {
+        throw std::runtime_error("value does not fit the plaintext space at this exponent");
+    }
+    return result;
+}
+
+PlainText FixedPointEncoder::encode(double value, int exponent) const
+{
+    PlainText plain{mantissa(value, exponent)};
+    mpz_mod(plain.text.get_mpz_t(), plain.text.get_mpz_t(), ns.get_mpz_t());
+    return plain;
+}
+
+/*
+ * Mantissas in the upper half of n^s are negative. A result that outgrew
+ * n^s/2 in magnitude wraps around and decodes to a wrong value.
+ */
+double FixedPointEncoder::decode(const PlainText &plain, int exponent) const
+{
+    mpz_class m{plain.text % ns};
+    if (2 * m >= ns)
+    {
+        m -= ns;
+    }
+
+    mpq_class value{m};
+    if (exponent < 0)
+    {
+        value /= scale(-exponent);
+    }
+    else
+    {
+        value *= scale(exponent);
+    }
+    return value.get_d();
+}
+
+EncodedNumber FixedPointEncoder::encrypt(double value, int exponent, const PublicContext &ctx) const
+{
+    return {encode(value, exponent).encrypt(ctx), exponent};
+}
+
+std::vector<EncodedNumber> FixedPointEncoder::encrypt(const std::vector<double> &values, const PublicContext &ctx) const
+{
+    std::vector<PlainText> plains(values.size());
+    std::transform(values.begin(), values.end(), plains.begin(), [this](double value) { return encode(value); });
+
+    const std::vector<CipherText> ciphers{encrypt_batch(plains, ctx)};
+    std::vector<EncodedNumber> numbers(ciphers.size());
+    std::transform(ciphers.begin(), ciphers.end(), numbers.begin(), [this](const CipherText &c) { return EncodedNumber{c, precision}; });
+    return numbers;
+}
+
+double FixedPointEncoder::decrypt(const EncodedNumber &number, const key::Private &priv) const
+{
+    return decode(number.cipher.decrypt(priv), number.exponent);
+}
+
+std::vector<double> FixedPointEncoder::decrypt(const std::vector<EncodedNumber> &numbers, const key::Private &priv) const
+{
+    const std::vector<PlainText> plains{decrypt_batch(
+        numbers.size(), [&numbers](std::size_t i) { return numbers[i].cipher.text; }, priv)};
+
+    std::vector<double> values(numbers.size());
+    for (std::size_t i = 0; i < numbers.size(); ++i)
+    {
+        values[i] = decode(plains[i], numbers[i].exponent);
+    }
+    return values;
+}
+
+/*
+ * Lowers the exponent of a number, multiplying its mantissa by base^(e - exponent)
+ * with one exponentiation. Exponents can only be lowered, raising them would drop digits.
+ */
+EncodedNumber FixedPointEncoder::align(const EncodedNumber &number, int exponent, const PublicContext &ctx) const
+{
+    if (exponent > number.exponent)
+    {
+        throw std::runtime_error("fixed point exponents can only be decreased");
+    }
+    if (exponent == number.exponent)
+    {
+        return number;
+    }
+    return {number.cipher.mult(scale(number.exponent - exponent), ctx), exponent};
+}
+
+/*
+ * Numbers of equal exponent add with a single multiplication, otherwise the
+ * one with the larger exponent is aligned to the smaller first.
+ */
+EncodedNumber FixedPointEncoder::add(const EncodedNumber &a, const EncodedNumber &b, const PublicContext &ctx) const
+{
+    const int exponent{std::min(a.exponent, b.exponent)};
+    return {align(a, exponent, ctx).cipher.add(align(b, exponent, ctx).cipher, ctx), exponent};
+}
+
+/*
+ * Adds a known value encoded at the smaller of the exponent of a and the
+ * precision, so its fraction is kept. Only a coarser a needs aligning.
+ */
+EncodedNumber FixedPointEncoder::add(const EncodedNumber &a, double b, const PublicContext &ctx) const
+{
+    const int exponent{std::min(a.exponent, precision)};
+    return {align(a, exponent, ctx).cipher.add_plain(PlainText{mantissa(b, exponent)}, ctx), exponent};
+}
+
+/*
+ * Multiplies by a known value encoded at the precision of the encoder, so the
+ * exponents add. Negative factors exponentiate the inverse of the ciphertext
+ * with the short mantissa instead of a mantissa reduced mod n^s.
+ */
+EncodedNumber FixedPointEncoder::mult(const EncodedNumber &a, double scalar, const PublicContext &ctx) const
+{
+    return {a.cipher.mult(mantissa(scalar, precision), ctx), a.exponent + precision};
+}
+
+/*
+ * Sums numbers of any exponents with the alignment deferred: numbers of the
+ * same exponent are first summed by plain multiplication, then the per
+ * exponent sums are aligned to the smallest exponent within a single
+ * multi-exponentiation, so each distinct exponent costs one term, not one powm per number.
+ */
+EncodedNumber FixedPointEncoder::sum(const std::vector<EncodedNumber> &numbers, const PublicContext &ctx) const
+{
+    std::map<int, std::vector<CipherText>> groups{};
+    for (const auto &number : numbers)
+    {
+        groups[number.exponent].push_back(number.cipher);
+    }
+
+    if (groups.empty())
+    {
+        return {CipherText{mpz_class{1U}}, precision};
+    }
+    if (groups.size() == 1)
+    {
+        return {impl::sum(groups.begin()->second, ctx), groups.begin()->first};
+    }
+
+    const int exponent{groups.begin()->first};
+    std::vector<mpz_class> sums{}, factors{};
+    for (const auto &[e, ciphers] : groups)
+    {
+        sums.push_back(impl::sum(ciphers, ctx).text);
+        factors.push_back(scale(e - exponent));
+    }
+
+    std::vector<mpz_srcptr> bases(sums.size()), exps(factors.size());
+    std::transform(sums.begin(), sums.end(), bases.begin(), [](const mpz_class &s) { return s.get_mpz_t(); });
+    std::transform(factors.begin(), factors.end(), exps.begin(), [](const mpz_class &f) { return f.get_mpz_t(); });
+
+    return {CipherText{tools::multi_exponentiation(bases, exps, ctx.n2)}, exponent};
+}
+
+/*
+ * Dot product with known weights encoded at the precision of the encoder.
+ *
+ * Term i lands at exponent e_i + precision. Instead of aligning the numbers
+ * first, the alignment factor base^(e_i - e_min) is folded into the scalar of
+ * term i, so the whole product stays one multi-exponentiation. Terms with a
+ * negative scalar use the inverse ciphertext, which keeps all exponents short.
+ */
+EncodedNumber FixedPointEncoder::dot(const std::vector<EncodedNumber> &numbers, const std::vector<double> &weights, const PublicContext &ctx) const
+{
+    if (numbers.size() != weights.size())
+    {
+        throw std::runtime_error("fixed point dot product of vectors of different lengths");
+    }
+    if (numbers.empty())
+    {
+        return {CipherText{mpz_class{1U}}, 2 * precision};
+    }
+
+    const int exponent{std::min_element(numbers.begin(), numbers.end(), [](const EncodedNumber &a, const EncodedNumber &b) {
+                           return a.exponent < b.exponent;
+                       })->exponent};
+
+    std::vector<mpz_class> bases(numbers.size()), scalars(numbers.size());
+    for (std::size_t i = 0; i < numbers.size(); ++i)
+    {
+        scalars[i] = mantissa(weights[i], precision) * scale(numbers[i].exponent - exponent);
+        bases[i] = numbers[i].cipher.text;
+        if (scalars[i] < 0)
+        {
+            scalars[i] = -scalars[i];
+            if (mpz_invert(bases[i].get_mpz_t(), bases[i].get_mpz_t(), ctx.n2.get_mpz_t()) == 0)
+            {
+                throw std::runtime_error("ciphertext is not invertible");
+            }
+        }
+    }
+
+    std::vector<mpz_srcptr> base_ptrs(bases.size()), exps(scalars.size());
+    std::transform(bases.begin(), bases.end(), base_ptrs.begin(), [](const mpz_class &b) { return b.get_mpz_t(); });
+    std::transform(scalars.begin(), scalars.end(), exps.begin(), [](const mpz_class &s) { return s.get_mpz_t(); });
+
+    return {CipherText{tools::multi_exponentiation(base_ptrs, exps, ctx.n2)}, exponent + precision};
+}
+
+} // paillier::impl
@@ -0,0 +1,54 @@
+#ifndef PAILLIER_ENCODING_HPP
+#define PAILLIER_ENCODING_HPP
+
+#include <gmpxx.h>
+#include <impl.hpp>
+#include <vector>
+
+namespace paillier::impl
+{
+
+class EncodedNumber
+{
+public:
+  CipherText cipher;
+  // the encrypted value is mantissa * base^exponent, with negative mantissas in the upper half of n^s
+  int exponent;
+};
+
+class FixedPointEncoder
+{
+  mpz_class ns;
+  unsigned base;
+  int precision;
+
+  mpz_class mantissa(double value, int exponent) const;
+  mpz_class scale(int steps) const;
+
+public:
+  FixedPointEncoder(const key::Public &pub, unsigned base = 2, int precision = -32);
+
+  unsigned radix() const { return base; }
+  int exponent() const { return precision; }
+
+  PlainText encode(double value) const { return encode(value, precision); }
+  PlainText encode(double value, int exponent) const;
+  double decode(const PlainText &plain, int exponent) const;
+
+  EncodedNumber encrypt(double value, const PublicContext &ctx) const { return encrypt(value, precision, ctx); }
+  EncodedNumber encrypt(double value, int exponent, const PublicContext &ctx) const;
+  std::vector<EncodedNumber> encrypt(const std::vector<double> &values, const PublicContext &ctx) const;
+  double decrypt(const EncodedNumber &number, const key::Private &priv) const;
+  std::vector<double> decrypt(const std::vector<EncodedNumber> &numbers, const key::Private &priv) const;
+
+  EncodedNumber align(const EncodedNumber &number, int exponent, const PublicContext &ctx) const;
+  EncodedNumber add(const EncodedNumber &a, const EncodedNumber &b, const PublicContext &ctx) const;
+  EncodedNumber add(const EncodedNumber &a, double b, const PublicContext &ctx) const;
+  EncodedNumber mult(const EncodedNumber &a, double scalar, const PublicContext &ctx) const;
+  EncodedNumber sum(const std::vector<EncodedNumber> &numbers, const PublicContext &ctx) const;
+  EncodedNumber dot(const std::vector<EncodedNumber> &numbers, const std::vector<double> &weights, const PublicContext &ctx) const;
+};
+
+} // paillier::impl
+
+#endif // PAILLIER_ENCODING_HPP
@@ -0,0 +1,190 @@
+#include "executor.hpp"
+#include <stdexcept>
+
+namespace paillier::tools
+{
+
+static std::mutex instance_lock;
+static std::unique_ptr<Executor> instance;
+static std::atomic<Executor *> current{nullptr};
+
+// worker threads remember which executor and queue they belong to
+static thread_local const Executor *owner = nullptr;
+static thread_local std::size_t owner_index = 0;
+
+/*
+ * Fixed set of workers, each owning a deque of tasks. Workers push and pop
+ * their own tasks at the back and steal from the front of other deques.
+ * Tasks submitted from outside the pool go to a shared injection queue.
+ */
+Executor::Executor(std::size_t workers) : pending(0), stopping(false)
+{
+    workers = workers == 0 ? 1 : workers;
+    for (std::size_t i = 0; i < workers; ++i)
+    {
+        queues.emplace_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < workers; ++i)
+    {
+        threads.emplace_back(&Executor::run, this, i);
+    }
+}
+
+Executor::~Executor()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+/*
+ * Returns the executor shared by the library, starting it with one worker
+ * per hardware thread unless init was called first.
+ */
+Executor &Executor::get()
+{
+    Executor *executor{current.load(std::memory_order_acquire)};
+    if (executor)
+    {
+        return *executor;
+    }
+
+    std::lock_guard<std::mutex> guard(instance_lock);
+    if (!instance)
+    {
+        instance.reset(new Executor(std::thread::hardware_concurrency()));
+        current.store(instance.get(), std::memory_order_release);
+    }
+    return *instance;
+}
+
+/*
+ * Starts the shared executor with the given number of workers.
+ * Must be called before the library first schedules work.
+ */
+void Executor::init(std::size_t workers)
+{
+    std::lock_guard<std::mutex> guard(instance_lock);
+    if (instance)
+    {
+        throw std::runtime_error("executor is already running");
+    }
+    instance.reset(new Executor(workers));
+    current.store(instance.get(), std::memory_order_release);
+}
+
+/*
+ * Index of the calling worker's queue, or the number of queues for threads outside the pool.
+ */
+std::size_t Executor::index() const
+{
+    return owner == this ? owner_index : queues.size();
+}
+
+void Executor::push(Task task)
+{
+    // counted before the task is visible so pending never drops below zero
+    pending.fetch_add(1, std::memory_order_release);
+
+    const std::size_t i{index()};
+    if (i < queues.size())
+    {
+        std::lock_guard<std::mutex> guard(queues[i]->lock);
+        queues[i]->tasks.push_back(std::move(task));
+    }
+    else
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        injected.push_back(std::move(task));
+    }
+
+    {
+        // pairs with the predicate check of sleeping workers so the wake up is not lost
+        std::lock_guard<std::mutex> guard(lock);
+    }
+    wake.notify_one();
+}
+
+/*
+ * Runs one queued task, looking at the caller's own deque first, then the
+ * injection queue, then stealing from the other workers.
+ */
+bool Executor::run_one()
+{
+    if (pending.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+
+    const std::size_t self{index()};
+    Task task{};
+
+    if (self < queues.size())
+    {
+        std::lock_guard<std::mutex> guard(queues[self]->lock);
+        if (!queues[self]->tasks.empty())
+        {
+            task = std::move(queues[self]->tasks.back());
+            queues[self]->tasks.pop_back();
+        }
+    }
+
+    if (!task)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!injected.empty())
+        {
+            task = std::move(injected.front());
+            injected.pop_front();
+        }
+    }
+
+    for (std::size_t offset = 1; !task && offset <= queues.size(); ++offset)
+    {
+        Queue &victim{*queues[(self + offset) % queues.size()]};
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+
+    if (!task)
+    {
+        return false;
+    }
+
+    pending.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+    return true;
+}
+
+void Executor::run(std::size_t i)
+{
+    owner = this;
+    owner_index = i;
+
+    for (;;)
+    {
+        if (run_one())
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(lock);
+        wake.wait(guard, [this] { return stopping || pending.load(std::memory_order_acquire) > 0; });
+        if (stopping)
+        {
+            return;
+        }
+    }
+}
+
+} // paillier::tools
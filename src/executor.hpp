@@ -0,0 +1,143 @@
+#ifndef PAILLIER_EXECUTOR_HPP
+#define PAILLIER_EXECUTOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace paillier::tools
+{
+
+class Executor
+{
+    using Task = std::function<void()>;
+
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::deque<Task> injected;
+    std::atomic<std::size_t> pending;
+    bool stopping;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::vector<std::thread> threads;
+
+    explicit Executor(std::size_t workers);
+
+    std::size_t index() const;
+    void push(Task task);
+    bool run_one();
+    void run(std::size_t index);
+
+  public:
+    Executor(Executor const &) = delete;
+    Executor(Executor &&) = delete;
+    ~Executor();
+
+    static Executor &get();
+    static void init(std::size_t workers);
+
+    std::size_t size() const { return threads.size(); }
+
+    template <typename F, typename... Args>
+    auto async(F &&f, Args &&... args)
+    {
+        using Result = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+            [f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                return std::apply(std::move(f), std::move(args));
+            });
+        std::future<Result> result = task->get_future();
+        push([task]() { (*task)(); });
+        return result;
+    }
+
+    /*
+     * Waits on a future produced by async. The waiting thread runs queued tasks in
+     * the meantime, so tasks may wait on their own subtasks without deadlocking.
+     */
+    template <typename Future>
+    decltype(auto) await(Future &&future)
+    {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            if (!run_one())
+            {
+                future.wait_for(std::chrono::microseconds(50));
+            }
+        }
+        return future.get();
+    }
+};
+
+/*
+ * Splits [0, count) into a few chunks per worker and runs body(first, last)
+ * for each chunk on the executor, returning once all chunks are done. Chunks
+ * refer to body and the caller's frame, so the first exception of a chunk is
+ * rethrown only after every chunk has finished.
+ */
+template <typename F>
+void parallel_for(const std::size_t count, F &&body)
+{
+    Executor &executor{Executor::get()};
+    const std::size_t tasks{4 * executor.size()},
+        chunk{count / tasks + (count % tasks != 0)};
+    std::vector<std::future<void>> chunks{};
+
+    for (std::size_t first = 0; first < count; first += chunk)
+    {
+        const std::size_t last{first + chunk < count ? first + chunk : count};
+        chunks.push_back(executor.async([&body, first, last]() { body(first, last); }));
+    }
+
+    std::exception_ptr failure{};
+    for (auto &done : chunks)
+    {
+        try
+        {
+            executor.await(done);
+        }
+        catch (...)
+        {
+            if (!failure)
+            {
+                failure = std::current_exception();
+            }
+        }
+    }
+    if (failure)
+    {
+        std::rethrow_exception(failure);
+    }
+}
+
+template <typename F, typename... Args>
+auto async(F &&f, Args &&... args)
+{
+    return Executor::get().async(std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template <typename Future>
+decltype(auto) await(Future &&future)
+{
+    return Executor::get().await(std::forward<Future>(future));
+}
+
+} // paillier::tools
+
+#endif // PAILLIER_EXECUTOR_HPP
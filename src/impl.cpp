@@ -1,9 +1,15 @@
 #include <cassert>
+#include <cctype>
 #include <cmath>
 #include <future>
+#include "executor.hpp"
 #include "impl.hpp"
+#include "metrics.hpp"
+#include "pool.hpp"
 #include <stdexcept>
+#include <string>
 #include "tools.hpp"
+#include <vector>
 
 namespace paillier::impl
 {
@@ -11,9 +17,40 @@ namespace paillier::impl
 namespace key
 {
 
+/*
+ * Extended key files append tagged sections after the legacy fields.
+ * Returns false once the stream holds no further section tag.
+ */
+static bool next_section(std::istream &is, std::string &tag)
+{
+    is >> std::ws;
+    if (!is || !std::isalpha(is.peek()))
+    {
+        return false;
+    }
+    return static_cast<bool>(is >> tag);
+}
+
 std::istream &operator>>(std::istream &is, Private &priv)
 {
     is >> priv.k >> priv.lambda >> priv.mu >> priv.n >> priv.p2 >> priv.p2invq2 >> priv.q2;
+
+    std::string tag{};
+    while (is && next_section(is, tag))
+    {
+        if (tag == "crt")
+        {
+            is >> priv.p >> priv.q >> priv.pinvq >> priv.hp >> priv.hq;
+        }
+        else if (tag == "s")
+        {
+            is >> priv.s;
+        }
+        else
+        {
+            is.setstate(std::ios::failbit);
+        }
+    }
     return is;
 }
 
@@ -26,12 +63,51 @@ std::ostream &operator<<(std::ostream &os, const Private &priv)
        << priv.p2 << "\n"
        << priv.p2invq2 << "\n"
        << priv.q2;
+    if (priv.hp != 0U)
+    {
+        os << "\ncrt\n"
+           << priv.p << "\n"
+           << priv.q << "\n"
+           << priv.pinvq << "\n"
+           << priv.hp << "\n"
+           << priv.hq;
+    }
+    if (priv.s != 1)
+    {
+        os << "\ns\n"
+           << priv.s;
+    }
     return os;
 }
 
 std::istream &operator>>(std::istream &is, Public &pub)
 {
     is >> pub.k >> pub.n >> pub.g;
+
+    std::string tag{};
+    while (is && next_section(is, tag))
+    {
+        if (tag == "hs")
+        {
+            auto table = std::make_shared<tools::Comb>();
+            is >> pub.hs >> *table;
+            pub.hs_table = table;
+        }
+        else if (tag == "g")
+        {
+            auto table = std::make_shared<tools::Comb>();
+            is >> *table;
+            pub.g_table = table;
+        }
+        else if (tag == "s")
+        {
+            is >> pub.s;
+        }
+        else
+        {
+            is.setstate(std::ios::failbit);
+        }
+    }
     return is;
 }
 
@@ -40,6 +116,22 @@ std::ostream &operator<<(std::ostream &os, const Public &pub)
     os << pub.k << "\n"
        << pub.n << "\n"
        << pub.g;
+    if (pub.hs != 0U && pub.hs_table)
+    {
+        os << "\nhs\n"
+           << pub.hs << "\n"
+           << *pub.hs_table;
+    }
+    if (pub.g_table)
+    {
+        os << "\ng\n"
+           << *pub.g_table;
+    }
+    if (pub.s != 1)
+    {
+        os << "\ns\n"
+           << pub.s;
+    }
     return os;
 }
 
@@ -55,6 +147,50 @@ mpz_class ell(const mpz_class input, const mpz_class n)
     return (input - 1U) / n;
 }
 
+/*
+ * Discrete logarithm to the base 1+p of an element a = (1+p)^i mod p^(s+1),
+ * returning i mod p^s. This is the iterative extraction of Damgard and Jurik:
+ * step j recovers i mod p^j from L(a mod p^(j+1)) by subtracting the binomial
+ * terms of the digits already known. For s = 1 it is L(a mod p^2).
+ *
+ * https://doi.org/10.1007/3-540-44586-2_9
+ */
+static mpz_class dlog(const mpz_class &a, const mpz_class &p, const unsigned s)
+{
+    mpz_class i{0U}, pj{p};
+
+    for (unsigned j = 1; j <= s; ++j)
+    {
+        const mpz_class pj1{pj * p};
+        mpz_class t1{ell(a % pj1, p)}, t2{i}, pk{1U}, factorial{1U}, inverse{};
+
+        for (unsigned k = 2; k <= j; ++k)
+        {
+            i -= 1U;
+            t2 = (t2 * i) % pj;
+            pk *= p;
+            factorial *= k;
+            mpz_invert(inverse.get_mpz_t(), factorial.get_mpz_t(), pj.get_mpz_t());
+            t1 -= t2 * pk * inverse;
+        }
+
+        mpz_mod(i.get_mpz_t(), t1.get_mpz_t(), pj.get_mpz_t());
+        pj = pj1;
+    }
+
+    return i;
+}
+
+/*
+ * Ciphertext modulus n^(s+1), n^2 for Paillier keys.
+ */
+mpz_class Public::modulus() const
+{
+    mpz_class result{};
+    mpz_pow_ui(result.get_mpz_t(), n.get_mpz_t(), s + 1);
+    return result;
+}
+
 /*
  * Generates Private and Public keys using specified bit width.
  * 
@@ -63,17 +199,20 @@ mpz_class ell(const mpz_class input, const mpz_class n)
  * 
  * https://en.wikipedia.org/wiki/Paillier_cryptosystem#Key_generation
  */
-std::pair<Private, Public> gen(const mp_bitcnt_t k)
+std::pair<Private, Public> gen(const mp_bitcnt_t k, const bool short_exponent, const unsigned s)
 {
     const mp_bitcnt_t pk = k / 2, qk = std::ceil(k / 2);
-    // find two probable primes p and q
-    mpz_class p{tools::Random::get().prime(pk)};
-    mpz_class q{tools::Random::get().prime(qk)};
+    const std::size_t streams{tools::Executor::get().size()};
+
+    // find two probable primes p and q concurrently, each as several speculative searches
+    std::future<mpz_class> f_q = tools::async([qk, streams]() { return tools::Random::get().prime(qk, streams); });
+    mpz_class p{tools::Random::get().prime(pk, streams)};
+    mpz_class q{tools::await(f_q)};
 
     // p needs to be relatively prime to q
     while (p == q)
     {
-        q = tools::Random::get().prime(qk);
+        q = tools::Random::get().prime(qk, streams);
     }
 
     // p should be less than q for CRT exponentiation
@@ -82,7 +221,13 @@ std::pair<Private, Public> gen(const mp_bitcnt_t k)
         p.swap(q);
     }
 
-    return key::seed(k, p, q);
+    auto keys = (s == 1 ? key::seed(k, p, q) : key::seed_degree(k, p, q, s));
+    if (short_exponent)
+    {
+        keys.second = key::with_short_exponent(keys.second);
+    }
+
+    return keys;
 }
 
 /*
@@ -128,6 +273,39 @@ mpz_class mu(const mpz_class n,
     return result;
 }
 
+/*
+ * Precompute the constants of CRT decryption for the prime p (resp. q):
+ *
+ * hp = L_p(g^(p-1) mod p^2)^-1 mod p, with L_p(x) = (x - 1) / p
+ *
+ * Keys of degree s take the logarithm to the base 1+p mod p^(s+1) instead, and invert mod p^s.
+ */
+static mpz_class crt_h(const mpz_class g, const mpz_class p, const unsigned s)
+{
+    mpz_class result{}, temp{}, ps{};
+    mpz_pow_ui(ps.get_mpz_t(), p.get_mpz_t(), s);
+    const mpz_class p_1{p - 1U}, ps1{ps * p}, g_p{g % ps1};
+
+    mpz_powm(temp.get_mpz_t(), g_p.get_mpz_t(), p_1.get_mpz_t(), ps1.get_mpz_t());
+    temp = dlog(temp, p, s);
+
+    if (!mpz_invert(result.get_mpz_t(), temp.get_mpz_t(), ps.get_mpz_t()))
+    {
+        throw std::runtime_error("no inverse, h, was found");
+    }
+
+    return result;
+}
+
+static void crt_constants(Private &priv, const mpz_class p, const mpz_class q, const mpz_class g)
+{
+    priv.p = p;
+    priv.q = q;
+    mpz_invert(priv.pinvq.get_mpz_t(), p.get_mpz_t(), q.get_mpz_t());
+    priv.hp = crt_h(g, p, 1);
+    priv.hq = crt_h(g, q, 1);
+}
+
 std::pair<Private, Public> seed(const mp_bitcnt_t k, const mpz_class p, const mpz_class q)
 {
     assert(p < q && "p should be less than q");
@@ -145,7 +323,10 @@ std::pair<Private, Public> seed(const mp_bitcnt_t k, const mpz_class p, const mp
         throw std::runtime_error("no inverse, mu, was found");
     }
 
-    return {{k, lambda, mu, n, p2, p2invq2, q2}, {k, n, 0U}};
+    Private priv{k, lambda, mu, n, p2, p2invq2, q2};
+    crt_constants(priv, p, q, n + 1U);
+
+    return {priv, {k, n, 0U}};
 }
 
 /*
@@ -165,11 +346,134 @@ std::pair<Private, Public> seed(const mp_bitcnt_t k, const mpz_class p, const mp
 
     const mpz_class mu{key::mu(n, g, lambda, p2, p2invq2, q2)};
 
-    return {{k, lambda, mu, n, p2, p2invq2, q2}, {k, n, g}};
+    Private priv{k, lambda, mu, n, p2, p2invq2, q2};
+    crt_constants(priv, p, q, g);
+
+    return {priv, {k, n, g}};
+}
+
+/*
+ * Damgard-Jurik keys of degree s with g=1+n: plaintexts mod n^s and ciphertexts mod n^(s+1).
+ * Decryption always uses the CRT, with hp, hq and p^-1 taken mod p^s and q^s,
+ * and mu = lambda^-1 mod n^s.
+ */
+std::pair<Private, Public> seed_degree(const mp_bitcnt_t k, const mpz_class p, const mpz_class q, const unsigned s)
+{
+    if (s == 0)
+    {
+        throw std::runtime_error("Damgard-Jurik degree s must be at least 1");
+    }
+
+    auto [priv, pub] = key::seed(k, p, q);
+    if (s == 1)
+    {
+        return {priv, pub};
+    }
+
+    mpz_class ns{}, ps{}, qs{};
+    mpz_pow_ui(ns.get_mpz_t(), priv.n.get_mpz_t(), s);
+    mpz_pow_ui(ps.get_mpz_t(), p.get_mpz_t(), s);
+    mpz_pow_ui(qs.get_mpz_t(), q.get_mpz_t(), s);
+
+    if (!mpz_invert(priv.mu.get_mpz_t(), priv.lambda.get_mpz_t(), ns.get_mpz_t()))
+    {
+        throw std::runtime_error("no inverse, mu, was found");
+    }
+    mpz_invert(priv.pinvq.get_mpz_t(), ps.get_mpz_t(), qs.get_mpz_t());
+    priv.hp = crt_h(priv.n + 1U, p, s);
+    priv.hq = crt_h(priv.n + 1U, q, s);
+    priv.s = s;
+    pub.s = s;
+
+    return {priv, pub};
+}
+
+/*
+ * Length of the random exponent used with the fixed base h_s.
+ * Twice the symmetric security level of a modulus of k bits.
+ */
+mp_bitcnt_t short_exponent_bits(const mp_bitcnt_t k)
+{
+    if (k < 2048)
+    {
+        return 160;
+    }
+    else if (k < 3072)
+    {
+        return 224;
+    }
+    else if (k < 4096)
+    {
+        return 256;
+    }
+    return 304;
+}
+
+/*
+ * Publishes the fixed base h_s = h^n mod n^2 with h = -x^2 mod n for a random unit x.
+ *
+ * Encryption then uses h_s^a for a short random a instead of r^n for a full width r,
+ * which is served from a fixed-base comb table kept with the public key.
+ */
+Public with_short_exponent(const Public &pub)
+{
+    Public result{pub};
+    const mpz_class n2{pub.modulus()},
+        x{tools::Random::get().relatively_prime(pub.n)};
+    mpz_class h{pub.n - (x * x) % pub.n}, ns{};
+
+    mpz_pow_ui(ns.get_mpz_t(), pub.n.get_mpz_t(), pub.s);
+    mpz_powm(result.hs.get_mpz_t(), h.get_mpz_t(), ns.get_mpz_t(), n2.get_mpz_t());
+    result.hs_table = std::make_shared<tools::Comb>(result.hs, n2, short_exponent_bits(pub.k));
+
+    return result;
+}
+
+/*
+ * Attaches a fixed-base comb table for g covering exponents up to n, so that
+ * encryption with a custom g computes g^m from the table.
+ */
+Public with_g_table(const Public &pub)
+{
+    Public result{pub};
+    if (!(pub.g == 0U || pub.g == (pub.n + 1U)))
+    {
+        result.g_table = std::make_shared<tools::Comb>(pub.g, pub.n * pub.n, mpz_sizeinbase(pub.n.get_mpz_t(), 2), 8);
+    }
+    return result;
 }
 
 } // key
 
+/*
+ * Caches everything the homomorphic operations derive from the public key:
+ * the ciphertext modulus n^2 (n^(s+1) for keys of degree s), whether g acts as 1+n, the limb size of n^2 and the Montgomery
+ * constant -(n^2)^-1 mod 2^GMP_NUMB_BITS for limb-level reduction.
+ * The comb table for a custom g is taken from the key or built on first use,
+ * and is shared by copies of the context.
+ */
+PublicContext::PublicContext(const key::Public &pub)
+    : tables(std::make_shared<Tables>()),
+      pub(pub),
+      n2(pub.modulus()),
+      ns(pub.n != 0U ? mpz_class{n2 / pub.n} : mpz_class{}),
+      g_n1(pub.g == 0U || pub.g == (pub.n + 1U)),
+      limbs(mpz_size(n2.get_mpz_t())),
+      ninv(0)
+{
+    if (limbs > 0)
+    {
+        // Newton iteration doubles the number of correct low bits of n0^-1 each step
+        const mp_limb_t n0{mpz_getlimbn(n2.get_mpz_t(), 0)};
+        mp_limb_t inv{n0};
+        for (unsigned bits = 3; bits < GMP_NUMB_BITS; bits *= 2)
+        {
+            inv *= 2 - n0 * inv;
+        }
+        ninv = -inv;
+    }
+}
+
 /*
  * "Add" two plaintexts homomorphically by multiplying ciphertexts modulo n^2.
  * For example, given the ciphertexts c1 and c2, encryptions of plaintexts m1 and m2,
@@ -177,17 +481,114 @@ std::pair<Private, Public> seed(const mp_bitcnt_t k, const mpz_class p, const mp
  */
 CipherText CipherText::add(CipherText a, key::Public pub) const
 {
-    return {(text * a.text) % (pub.n * pub.n)};
+    const tools::OperationTimer timer{tools::Operation::add};
+    return {(text * a.text) % pub.modulus()};
+}
+
+/*
+ * Same as above, with n^2 taken from the context.
+ */
+CipherText CipherText::add(const CipherText &a, const PublicContext &ctx) const
+{
+    const tools::OperationTimer timer{tools::Operation::add};
+    CipherText result{};
+    mpz_mul(result.text.get_mpz_t(), text.get_mpz_t(), a.text.get_mpz_t());
+    mpz_mod(result.text.get_mpz_t(), result.text.get_mpz_t(), ctx.n2.get_mpz_t());
+    return result;
+}
+
+/*
+ * Decryption of the residue of c modulo p^2 (resp. q^2).
+ *
+ * Keys carrying CRT constants return m_p = L_p(c^(p-1) mod p^2)*hp mod p,
+ * other keys return c^lambda mod p^2.
+ */
+static mpz_class decrypt_half(const mpz_class &c, const mpz_class &exp, const mpz_class &p, const mpz_class &p2, const mpz_class &hp)
+{
+    mpz_class result{c % p2};
+    mpz_powm(result.get_mpz_t(), result.get_mpz_t(), exp.get_mpz_t(), p2.get_mpz_t());
+
+    if (hp != 0U)
+    {
+        result = key::ell(result, p) * hp;
+        mpz_mod(result.get_mpz_t(), result.get_mpz_t(), p.get_mpz_t());
+    }
+
+    return result;
+}
+
+/*
+ * Decryption of the residue of c modulo p^(s+1) for keys of degree s:
+ * m_p = log(c^(p-1) mod p^(s+1))*hp mod p^s, with the logarithm to the base 1+p.
+ */
+static mpz_class decrypt_half(const mpz_class &c, const mpz_class &p, const unsigned s, const mpz_class &hp)
+{
+    mpz_class ps{}, result{};
+    mpz_pow_ui(ps.get_mpz_t(), p.get_mpz_t(), s);
+    const mpz_class p_1{p - 1U}, ps1{ps * p};
+
+    result = c % ps1;
+    mpz_powm(result.get_mpz_t(), result.get_mpz_t(), p_1.get_mpz_t(), ps1.get_mpz_t());
+    result = key::dlog(result, p, s) * hp;
+    mpz_mod(result.get_mpz_t(), result.get_mpz_t(), ps.get_mpz_t());
+
+    return result;
+}
+
+mpz_class key::Private::half_p(const mpz_class &c) const
+{
+    if (s != 1)
+    {
+        return decrypt_half(c, p, s, hp);
+    }
+    return hp != 0U ? decrypt_half(c, p - 1U, p, p2, hp) : decrypt_half(c, lambda, p, p2, 0U);
+}
+
+mpz_class key::Private::half_q(const mpz_class &c) const
+{
+    if (s != 1)
+    {
+        return decrypt_half(c, q, s, hq);
+    }
+    return hp != 0U ? decrypt_half(c, q - 1U, q, q2, hq) : decrypt_half(c, lambda, q, q2, 0U);
+}
+
+/*
+ * Recombines the two halves of a decryption into the plaintext mod n.
+ * Keys carrying CRT constants recombine m_p and m_q directly, other keys
+ * recombine c^lambda mod n^2 and compute L(c^lambda mod n^2)*mu mod n.
+ */
+mpz_class key::Private::combine(const mpz_class &rp, const mpz_class &rq) const
+{
+    if (s != 1)
+    {
+        mpz_class ps{}, qs{};
+        mpz_pow_ui(ps.get_mpz_t(), p.get_mpz_t(), s);
+        mpz_pow_ui(qs.get_mpz_t(), q.get_mpz_t(), s);
+        return tools::crt_combine(rp, rq, pinvq, ps, qs);
+    }
+    if (hp != 0U)
+    {
+        return tools::crt_combine(rp, rq, pinvq, p, q);
+    }
+
+    const mpz_class crt{tools::crt_combine(rp, rq, p2invq2, p2, q2)};
+    return (key::ell(crt, n) * mu) % n;
 }
 
 /*
  * The decryption function computes m = L(c^lambda mod n^2)*mu mod n.
- * The exponentiation is calculated using the CRT, and exponentiations mod p^2 and q^2 run in their own thread.
+ * The exponentiation is calculated using the CRT, and exponentiations mod p^2 and q^2 run as separate tasks.
+ *
+ * Keys carrying CRT constants decrypt mod p and mod q separately with the shorter exponents
+ * p-1 and q-1, and recombine m_p and m_q mod n without the final multiplication by mu.
  */
 PlainText CipherText::decrypt(key::Private priv) const
 {
-    mpz_class crt{tools::crt_exponentiation(text, priv.lambda, priv.lambda, priv.p2invq2, priv.p2, priv.q2)};
-    return {(key::ell(crt, priv.n) * priv.mu) % priv.n};
+    const tools::OperationTimer timer{tools::Operation::decrypt};
+    std::future<mpz_class> f_rp = tools::async([&]() { return priv.half_p(text); });
+    const mpz_class rq{priv.half_q(text)};
+    return {priv.combine(tools::await(f_rp), rq)};
 }
 
 /*
@@ -197,12 +598,102 @@ PlainText CipherText::decrypt(key::Private priv) const
  */
 CipherText CipherText::mult(mpz_class constant, key::Public pub) const
 {
+    const tools::OperationTimer timer{tools::Operation::mult};
     mpz_class result{};
-    mpz_class n2{pub.n * pub.n};
+    mpz_class n2{pub.modulus()};
     mpz_powm(result.get_mpz_t(), text.get_mpz_t(), constant.get_mpz_t(), n2.get_mpz_t());
     return {result};
 }
 
+/*
+ * Same as above, with n^2 taken from the context.
+ */
+CipherText CipherText::mult(const mpz_class &constant, const PublicContext &ctx) const
+{
+    const tools::OperationTimer timer{tools::Operation::mult};
+    CipherText result{};
+    mpz_powm(result.text.get_mpz_t(), text.get_mpz_t(), constant.get_mpz_t(), ctx.n2.get_mpz_t());
+    return result;
+}
+
+/*
+ * c*g^m mod n^2 for a plaintext m already reduced mod n^s.
+ * For g=1+n and s=1, c*(1+n*m) = c + n*(c*m mod n) mod n^2, which only
+ * multiplies numbers of the size of n.
+ */
+static CipherText shift(const mpz_class &c, const mpz_class &m, const PublicContext &ctx)
+{
+    CipherText result{};
+    mpz_ptr r{result.text.get_mpz_t()};
+
+    if (ctx.g_n1 && ctx.pub.s == 1)
+    {
+        mpz_mul(r, c.get_mpz_t(), m.get_mpz_t());
+        mpz_mod(r, r, ctx.pub.n.get_mpz_t());
+        mpz_mul(r, r, ctx.pub.n.get_mpz_t());
+        mpz_add(r, r, c.get_mpz_t());
+    }
+    else
+    {
+        result.text = ctx.power(m);
+        mpz_mul(r, r, c.get_mpz_t());
+    }
+
+    if (mpz_cmp(r, ctx.n2.get_mpz_t()) >= 0)
+    {
+        mpz_mod(r, r, ctx.n2.get_mpz_t());
+    }
+    return result;
+}
+
+/*
+ * Adds a known plaintext without encrypting it. No randomness is drawn, so the
+ * result is exactly as random as c: callers applying many plaintext operations
+ * should rerandomize the final result once before publishing it.
+ */
+CipherText CipherText::add_plain(const PlainText &m, const PublicContext &ctx) const
+{
+    const tools::OperationTimer timer{tools::Operation::add};
+    mpz_class reduced{};
+    mpz_mod(reduced.get_mpz_t(), m.text.get_mpz_t(), ctx.ns.get_mpz_t());
+    return shift(text, reduced, ctx);
+}
+
+CipherText CipherText::sub_plain(const PlainText &m, const PublicContext &ctx) const
+{
+    const tools::OperationTimer timer{tools::Operation::add};
+    mpz_class reduced{-m.text};
+    mpz_mod(reduced.get_mpz_t(), reduced.get_mpz_t(), ctx.ns.get_mpz_t());
+    return shift(text, reduced, ctx);
+}
+
+/*
+ * Multiplies the plaintext by k: c^(k mod n^s) mod n^2. Negative factors and
+ * factors above n^s are reduced first, so no modular inverse of c is needed.
+ */
+CipherText CipherText::mult_plain(const PlainText &k, const PublicContext &ctx) const
+{
+    const tools::OperationTimer timer{tools::Operation::mult};
+    mpz_class reduced{};
+    mpz_mod(reduced.get_mpz_t(), k.text.get_mpz_t(), ctx.ns.get_mpz_t());
+
+    CipherText result{};
+    mpz_powm(result.text.get_mpz_t(), text.get_mpz_t(), reduced.get_mpz_t(), ctx.n2.get_mpz_t());
+    return result;
+}
+
+/*
+ * Multiplies in a fresh randomizer r^n (h_s^a for keys carrying h_s), so the
+ * result decrypts to the same plaintext but is unlinkable to c.
+ */
+CipherText CipherText::rerandomize(const PublicContext &ctx) const
+{
+    CipherText result{ctx.randomizer(ctx.nonces(1).front())};
+    mpz_mul(result.text.get_mpz_t(), result.text.get_mpz_t(), text.get_mpz_t());
+    mpz_mod(result.text.get_mpz_t(), result.text.get_mpz_t(), ctx.n2.get_mpz_t());
+    return result;
+}
+
 std::istream &operator>>(std::istream &is, CipherText &cipher)
 {
     is >> cipher.text;
@@ -216,53 +707,247 @@ std::ostream &operator<<(std::ostream &os, const CipherText &cipher)
 }
 
 /*
- * The function calculates c=g^m*r^n mod n^2 with r random number.
- * Encryption benefits from the fact that g=1+n, because (1+n)^m = 1+n*m mod n^2.
+ * Draws the random values of count encryptions at once: r relatively prime to n,
+ * or short exponents a when the key carries a fixed base h_s.
+ *
+ * Encryption and decryption do not work properly for g = 1+n*m when the
+ * random number chosen is a multiple of primes p or q
+ *
+ * https://crypto.stackexchange.com/questions/18058/choosing-primes-in-the-paillier-cryptosystem
  */
-CipherText PlainText::encrypt(key::Public pub) const
+static std::vector<mpz_class> nonces(const key::Public &pub, const std::size_t count)
 {
-    static const auto exponentiate = [](const mpz_class basis, const mpz_class exp, const mpz_class modulus) {
-        mpz_class result{};
-        mpz_powm(result.get_mpz_t(), basis.get_mpz_t(), exp.get_mpz_t(), modulus.get_mpz_t());
-        return result;
-    };
+    if (pub.hs != 0U)
+    {
+        const mp_bitcnt_t bits{pub.hs_table ? pub.hs_table->width() : key::short_exponent_bits(pub.k)};
+        mpz_class bound{};
+        mpz_ui_pow_ui(bound.get_mpz_t(), 2U, bits);
+        return tools::Random::get().random_n(bound, count);
+    }
+
+    return tools::Random::get().relatively_prime(pub.n, count);
+}
+
+/*
+ * Randomizer of an encryption: r^n mod n^2 (r^(n^s) mod n^(s+1) for keys of degree s), or h_s^a for keys carrying a fixed base h_s.
+ */
+static mpz_class randomizer(const key::Public &pub, const mpz_class &n2, const mpz_class &nonce)
+{
+    mpz_class result{};
 
-    static const auto relatively_prime = [](const mpz_class n) {
-        mpz_class result{0U};
-        while (result == 0U || gcd(result, n) != 1)
+    if (pub.hs != 0U)
+    {
+        if (pub.hs_table)
         {
-            result = tools::Random::get().random_n(n);
+            return pub.hs_table->pow(nonce);
         }
+        mpz_powm(result.get_mpz_t(), pub.hs.get_mpz_t(), nonce.get_mpz_t(), n2.get_mpz_t());
         return result;
-    };
+    }
+
+    if (pub.s != 1)
+    {
+        mpz_class ns{};
+        mpz_pow_ui(ns.get_mpz_t(), pub.n.get_mpz_t(), pub.s);
+        mpz_powm(result.get_mpz_t(), nonce.get_mpz_t(), ns.get_mpz_t(), n2.get_mpz_t());
+        return result;
+    }
+
+    mpz_powm(result.get_mpz_t(), nonce.get_mpz_t(), pub.n.get_mpz_t(), n2.get_mpz_t());
+    return result;
+}
+
+static mpz_class randomizer(const key::Public &pub, const mpz_class &n2)
+{
+    return randomizer(pub, n2, nonces(pub, 1).front());
+}
+
+/*
+ * (1+n)^m mod n^(s+1) by the binomial theorem: the sum of C(m, k)*n^k for k <= s,
+ * since higher powers of n vanish. For s = 1 this is 1+n*m.
+ */
+static mpz_class one_plus_n_power(const key::Public &pub, const mpz_class &modulus, const mpz_class &m)
+{
+    if (pub.s == 1)
+    {
+        return (m * pub.n) + 1U;
+    }
+
+    mpz_class result{1U}, binomial{}, nk{1U};
+    for (unsigned k = 1; k <= pub.s; ++k)
+    {
+        nk *= pub.n;
+        mpz_bin_ui(binomial.get_mpz_t(), m.get_mpz_t(), k);
+        result += binomial * nk;
+    }
+    mpz_mod(result.get_mpz_t(), result.get_mpz_t(), modulus.get_mpz_t());
+
+    return result;
+}
+
+/*
+ * g^m mod n^2, which is 1+n*m mod n^2 for g=1+n.
+ * A custom g is served from the key's comb table when it carries one.
+ */
+static mpz_class plain_power(const key::Public &pub, const mpz_class &n2, const mpz_class &m)
+{
+    mpz_class result{};
+
+    if (pub.g == 0U || pub.g == (pub.n + 1U))
+    {
+        result = one_plus_n_power(pub, n2, m);
+    }
+    else if (pub.g_table)
+    {
+        result = pub.g_table->pow(m);
+    }
+    else
+    {
+        mpz_powm(result.get_mpz_t(), pub.g.get_mpz_t(), m.get_mpz_t(), n2.get_mpz_t());
+    }
+
+    return result;
+}
+
+std::vector<mpz_class> PublicContext::nonces(const std::size_t count) const
+{
+    return impl::nonces(pub, count);
+}
+
+mpz_class PublicContext::randomizer(const mpz_class &nonce) const
+{
+    return impl::randomizer(pub, n2, nonce);
+}
+
+mpz_class PublicContext::power(const mpz_class &m) const
+{
+    if (g_n1)
+    {
+        return one_plus_n_power(pub, n2, m);
+    }
+    return g_table().pow(m);
+}
+
+const tools::Comb &PublicContext::g_table() const
+{
+    std::call_once(tables->built, [this]() {
+        tables->g = pub.g_table ? pub.g_table : key::with_g_table(pub).g_table;
+    });
+    return *tables->g;
+}
+
+/*
+ * The function calculates c=g^m*r^n mod n^2 with r random number.
+ * Encryption benefits from the fact that g=1+n, because (1+n)^m = 1+n*m mod n^2.
+ * Keys carrying a fixed base h_s replace r^n with h_s^a for a short random exponent a.
+ */
+CipherText PlainText::encrypt(key::Public pub) const
+{
+    const tools::OperationTimer timer{tools::Operation::encrypt};
+    mpz_class result{};
+
+    if (pub.s != 1 || pub.n != text)
+    {
+        const mpz_class n2{pub.modulus()};
+
+        std::future<mpz_class> f_temp = tools::async(plain_power, pub, n2, text);
+
+        result = randomizer(pub, n2);
+        result *= tools::await(f_temp);
+        result %= n2;
+    }
+
+    return {result};
+}
+
+/*
+ * Same as above, but r^n mod n^2 is taken from a pool that precomputes it ahead of time,
+ * so only g^m and one multiplication modulo n^2 remain on the caller's thread.
+ */
+CipherText PlainText::encrypt(key::Public pub, RandomnessPool &pool) const
+{
+    const tools::OperationTimer timer{tools::Operation::encrypt};
+    if (pool.modulus() != pub.n || pub.s != 1)
+    {
+        throw std::runtime_error("randomness pool was built for a different public key");
+    }
 
     mpz_class result{};
 
     if (pub.n != text)
     {
-        /* 
-         * Encryption and decryption do not work properly for g = 1+n*m when the
-         * random number chosen is a multiple of primes p or q
-         *
-         * https://crypto.stackexchange.com/questions/18058/choosing-primes-in-the-paillier-cryptosystem
-         */
-        std::future<mpz_class> f_random = std::async(relatively_prime, pub.n), f_temp;
-        const mpz_class n2{pub.n * pub.n};
+        const mpz_class n2{pub.modulus()};
 
-        std::future<mpz_class> f_result = std::async(exponentiate, f_random.get(), pub.n, n2);
+        result = plain_power(pub, n2, text);
+        result *= pool.take();
+        result %= n2;
+    }
+
+    return {result};
+}
 
-        if (pub.g == 0U || pub.g == (pub.n + 1U))
+/*
+ * Same as above, with n^2 taken from the context.
+ * g^m only runs in its own thread when g is not 1+n.
+ */
+CipherText PlainText::encrypt(const PublicContext &ctx) const
+{
+    const tools::OperationTimer timer{tools::Operation::encrypt};
+    mpz_class result{};
+
+    if (ctx.pub.s != 1 || ctx.pub.n != text)
+    {
+        if (ctx.g_n1)
         {
-            f_temp = std::async([=]() -> mpz_class { return (text * pub.n) + 1U; });
+            result = randomizer(ctx.pub, ctx.n2);
+            result *= ctx.power(text);
         }
         else
         {
-            f_temp = std::async(exponentiate, pub.g, text, n2);
+            std::future<mpz_class> f_temp = tools::async([&]() { return ctx.power(text); });
+            result = randomizer(ctx.pub, ctx.n2);
+            result *= tools::await(f_temp);
         }
+        mpz_mod(result.get_mpz_t(), result.get_mpz_t(), ctx.n2.get_mpz_t());
+    }
 
-        result = f_result.get();
-        result *= f_temp.get();
-        result %= n2;
+    return {result};
+}
+
+/*
+ * Encryption for holders of the private key with g=1+n.
+ * r^n is computed separately mod p^2 and mod q^2 with the exponent n reduced mod
+ * phi(p^2)=p(p-1) and phi(q^2)=q(q-1), then recombined with Garner's method.
+ *
+ * The key was generated with g=1+n (or an equivalent g) exactly when lambda*mu = 1 mod n.
+ * Keys without the crt section recover p and q from p^2 and q^2.
+ */
+CipherText PlainText::encrypt(const key::Private &priv) const
+{
+    const tools::OperationTimer timer{tools::Operation::encrypt};
+    if (priv.s != 1 || (priv.lambda * priv.mu) % priv.n != 1U)
+    {
+        throw std::runtime_error("CRT encryption requires a Paillier key with g = n + 1");
+    }
+
+    mpz_class result{};
+
+    if (priv.n != text)
+    {
+        mpz_class p{priv.p}, q{priv.q};
+        if (p == 0U)
+        {
+            mpz_sqrt(p.get_mpz_t(), priv.p2.get_mpz_t());
+            mpz_sqrt(q.get_mpz_t(), priv.q2.get_mpz_t());
+        }
+
+        const mpz_class exp_p{priv.n % (p * (p - 1U))},
+            exp_q{priv.n % (q * (q - 1U))},
+            r{tools::Random::get().relatively_prime(priv.n)};
+
+        result = tools::crt_exponentiation(r, exp_p, exp_q, priv.p2invq2, priv.p2, priv.q2);
+        result *= (text * priv.n) + 1U;
+        result %= priv.n * priv.n;
     }
 
     return {result};
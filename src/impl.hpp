@@ -3,6 +3,10 @@
 
 #include <iostream>
 #include <gmpxx.h>
+#include <memory>
+#include <mutex>
+#include "tools.hpp"
+#include <vector>
 
 namespace paillier::impl
 {
@@ -20,6 +24,14 @@ public:
       p2,
       p2invq2,
       q2;
+  // CRT decryption constants, zero for keys without the crt section
+  mpz_class p,
+      q,
+      pinvq,
+      hp,
+      hq;
+  // Damgard-Jurik degree: plaintexts mod n^s, ciphertexts mod n^(s+1)
+  unsigned s{1};
 
   Private() = default;
   Private(
@@ -39,6 +51,10 @@ public:
   {
   }
 
+  mpz_class half_p(const mpz_class &c) const;
+  mpz_class half_q(const mpz_class &c) const;
+  mpz_class combine(const mpz_class &rp, const mpz_class &rq) const;
+
   friend std::istream &operator>>(std::istream &is, Private &priv);
   friend std::ostream &operator<<(std::ostream &os, const Private &priv);
 };
@@ -47,7 +63,10 @@ class Public
 {
 public:
   mp_bitcnt_t k;
-  mpz_class n, g;
+  mpz_class n, g, hs;
+  std::shared_ptr<const tools::Comb> hs_table, g_table;
+  // Damgard-Jurik degree: plaintexts mod n^s, ciphertexts mod n^(s+1)
+  unsigned s{1};
 
   Public() = default;
   Public(
@@ -59,12 +78,14 @@ public:
   {
   }
 
+  mpz_class modulus() const;
+
   friend std::istream &operator>>(std::istream &is, Public &pub);
   friend std::ostream &operator<<(std::ostream &os, const Public &pub);
 };
 
 mpz_class ell(const mpz_class input, const mpz_class n);
-std::pair<Private, Public> gen(const mp_bitcnt_t k);
+std::pair<Private, Public> gen(const mp_bitcnt_t k, const bool short_exponent = false, const unsigned s = 1);
 mpz_class lambda(const mpz_class p, const mpz_class q);
 mpz_class mu(const mpz_class n,
              const mpz_class g,
@@ -74,11 +95,41 @@ mpz_class mu(const mpz_class n,
              const mpz_class q2);
 std::pair<Private, Public> seed(const mp_bitcnt_t k, const mpz_class p, const mpz_class q);
 std::pair<Private, Public> seed(const mp_bitcnt_t k, const mpz_class p, const mpz_class q, const mpz_class g);
+std::pair<Private, Public> seed_degree(const mp_bitcnt_t k, const mpz_class p, const mpz_class q, const unsigned s);
+mp_bitcnt_t short_exponent_bits(const mp_bitcnt_t k);
+Public with_short_exponent(const Public &pub);
+Public with_g_table(const Public &pub);
 
 } // key
 
 class CipherText;
 class PlainText;
+class RandomnessPool;
+
+class PublicContext
+{
+  struct Tables
+  {
+    std::once_flag built;
+    std::shared_ptr<const tools::Comb> g;
+  };
+  std::shared_ptr<Tables> tables;
+
+public:
+  key::Public pub;
+  // ciphertext modulus n^(s+1) and plaintext modulus n^s
+  mpz_class n2, ns;
+  bool g_n1;
+  mp_size_t limbs;
+  mp_limb_t ninv;
+
+  explicit PublicContext(const key::Public &pub);
+
+  std::vector<mpz_class> nonces(const std::size_t count) const;
+  mpz_class randomizer(const mpz_class &nonce) const;
+  mpz_class power(const mpz_class &m) const;
+  const tools::Comb &g_table() const;
+};
 
 class CipherText
 {
@@ -88,8 +139,14 @@ public:
   CipherText() = default;
   CipherText(mpz_class text) : text(text) {}
   CipherText add(CipherText a, key::Public pub) const;
+  CipherText add(const CipherText &a, const PublicContext &ctx) const;
   PlainText decrypt(key::Private priv) const;
   CipherText mult(mpz_class c, key::Public pub) const;
+  CipherText mult(const mpz_class &c, const PublicContext &ctx) const;
+  CipherText add_plain(const PlainText &m, const PublicContext &ctx) const;
+  CipherText sub_plain(const PlainText &m, const PublicContext &ctx) const;
+  CipherText mult_plain(const PlainText &k, const PublicContext &ctx) const;
+  CipherText rerandomize(const PublicContext &ctx) const;
 
   friend std::istream &operator>>(std::istream &is, CipherText &cipher);
   friend std::ostream &operator<<(std::ostream &os, const CipherText &cipher);
@@ -102,6 +159,9 @@ public:
   PlainText() = default;
   PlainText(mpz_class text) : text(text) {}
   CipherText encrypt(key::Public pub) const;
+  CipherText encrypt(key::Public pub, RandomnessPool &pool) const;
+  CipherText encrypt(const key::Private &priv) const;
+  CipherText encrypt(const PublicContext &ctx) const;
 
   friend std::istream &operator>>(std::istream &is, PlainText &plain);
   friend std::ostream &operator<<(std::ostream &os, const PlainText &plain);
@@ -1,6 +1,7 @@
 #include <fstream>
 #include "impl.hpp"
 #include "io.hpp"
+#include <stdexcept>
 
 namespace paillier::io
 {
@@ -8,31 +9,41 @@ namespace paillier::io
 void add(ssv cipher_result_out, ssv cipher_a_in, ssv cipher_b_in, ssv pub_key_in)
 {
     impl::key::Public pub{};
-    impl::CipherText a{}, b{}, result{};
 
     std::fstream pub_key(pub_key_in.data(), pub_key.in);
     std::fstream cipher_a(cipher_a_in.data(), cipher_a.in);
     std::fstream cipher_b(cipher_b_in.data(), cipher_b.in);
     std::fstream cipher_result(cipher_result_out.data(), cipher_result.out);
 
-    pub_key >> pub;
-    cipher_a >> a;
-    cipher_b >> b;
-    cipher_result << a.add(b, pub) << std::endl;
+    read_key(pub_key, pub);
+    const impl::PublicContext ctx{pub};
+    const auto a = read_ciphers(cipher_a, pub), b = read_ciphers(cipher_b, pub);
+
+    if (a.size() != b.size())
+    {
+        throw std::runtime_error("ciphertext files hold different numbers of values");
+    }
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        cipher_result << a[i].add(b[i], ctx) << "\n";
+    }
+    cipher_result.flush();
 }
 
 void decrypt(ssv plain_out, ssv cipher_in, ssv priv_key_in)
 {
     impl::key::Private priv{};
-    impl::CipherText c{};
 
     std::fstream priv_key(priv_key_in.data(), priv_key.in);
     std::fstream cipher(cipher_in.data(), cipher.in);
     std::fstream plain(plain_out.data(), plain.out);
 
-    priv_key >> priv;
-    cipher >> c;
-    plain << c.decrypt(priv) << std::endl;
+    read_key(priv_key, priv);
+    for (const auto &c : read_ciphers(cipher))
+    {
+        plain << c.decrypt(priv) << "\n";
+    }
+    plain.flush();
 }
 
 void encrypt(ssv cipher_out, ssv plain_in, ssv pub_key_in)
@@ -44,19 +55,19 @@ void encrypt(ssv cipher_out, ssv plain_in, ssv pub_key_in)
     std::fstream plain(plain_in.data(), plain.in);
     std::fstream cipher(cipher_out.data(), cipher.out);
 
-    pub_key >> pub;
+    read_key(pub_key, pub);
     plain >> p;
     cipher << p.encrypt(pub) << std::endl;
 }
 
-void keygen(ssv pub_out, ssv priv_out, mp_bitcnt_t len)
+void keygen(ssv pub_out, ssv priv_out, mp_bitcnt_t len, bool short_exponent, unsigned s)
 {
     std::fstream pub(pub_out.data(), pub.out);
     std::fstream priv(priv_out.data(), priv.out);
 
     try
     {
-        const auto & [ priv_key, pub_key ] = impl::key::gen(len);
+        const auto & [ priv_key, pub_key ] = impl::key::gen(len, short_exponent, s);
         pub << pub_key;
         priv << priv_key;
     }
@@ -91,7 +102,7 @@ void keyseed(ssv pub_out, ssv priv_out, ssv seed_in)
     try
     {
         const auto & [ priv_key, pub_key ] = (g == 0U ? impl::key::seed(k, p, q) : impl::key::seed(k, p, q, g));
-        pub << pub_key;
+        pub << impl::key::with_g_table(pub_key);
         priv << priv_key;
     }
     catch (const std::runtime_error &e)
@@ -110,17 +121,20 @@ void mult_c(ssv cipher_result_out, ssv cipher_in, ssv constant_in, ssv pub_key_i
 {
     impl::key::Public pub{};
     mpz_class cst{};
-    impl::CipherText c{};
 
     std::fstream pub_key(pub_key_in.data(), pub_key.in);
     std::fstream constant(constant_in.data(), constant.in);
     std::fstream cipher(cipher_in.data(), cipher.in);
     std::fstream cipher_result(cipher_result_out.data(), cipher_result.out);
 
-    pub_key >> pub;
+    read_key(pub_key, pub);
     constant >> cst;
-    cipher >> c;
-    cipher_result << c.mult(cst, pub) << std::endl;
+    const impl::PublicContext ctx{pub};
+    for (const auto &c : read_ciphers(cipher, pub))
+    {
+        cipher_result << c.mult(cst, ctx) << "\n";
+    }
+    cipher_result.flush();
 }
 
 } // paillier::io
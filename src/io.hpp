@@ -1,18 +1,72 @@
 #ifndef PAILLIER_IO_HPP
 #define PAILLIER_IO_HPP
 
+#include <array>
+#include <cstdint>
 #include <gmpxx.h>
+#include <impl.hpp>
+#include <iostream>
 #include <string>
+#include <vector>
 
 namespace paillier::io
 {
 
 using ssv = std::string_view;
 
+enum class Format
+{
+    text,
+    binary
+};
+
+enum class Kind : std::uint16_t
+{
+    ciphers = 1,
+    public_key = 2,
+    private_key = 3
+};
+
+struct Header
+{
+    static constexpr std::size_t size = 32;
+    static constexpr std::uint16_t current = 1;
+
+    std::uint16_t version;
+    Kind kind;
+    std::uint64_t fingerprint;
+    std::uint32_t limbs;
+    std::uint64_t count;
+
+    std::array<std::uint8_t, size> serialize() const;
+    static Header parse(const std::uint8_t *bytes);
+};
+
+std::uint64_t fingerprint(const mpz_class &n);
+std::uint32_t limbs(const mpz_class &value);
+Format detect(std::istream &is);
+
+void export_limbs(std::uint8_t *out, const mpz_class &value, std::uint32_t limbs);
+void import_limbs(mpz_class &value, const std::uint8_t *in, std::uint32_t limbs);
+Header read_header(std::istream &is, Kind kind);
+
+std::vector<impl::CipherText> read_ciphers(std::istream &is);
+std::vector<impl::CipherText> read_ciphers(std::istream &is, const impl::key::Public &pub);
+void read_key(std::istream &is, impl::key::Public &pub);
+void read_key(std::istream &is, impl::key::Private &priv);
+void write_ciphers(std::ostream &os, const std::vector<impl::CipherText> &ciphers, const impl::key::Public &pub, Format format = Format::binary);
+void write_key(std::ostream &os, const impl::key::Public &pub, Format format = Format::binary);
+void write_key(std::ostream &os, const impl::key::Private &priv, Format format = Format::binary);
+
+void encrypt_stream(std::istream &plains, std::ostream &ciphers, const impl::key::Public &pub, Format format = Format::text, std::size_t chunk = 4096);
+void decrypt_stream(std::istream &ciphers, std::ostream &plains, const impl::key::Private &priv, std::size_t chunk = 4096);
+
 void add(ssv cipher_result_out, ssv cipher_a_in, ssv cipher_b_in, ssv pub_key_in);
 void decrypt(ssv plain_out, ssv cipher_in, ssv priv_key_in);
+void decrypt_stream(ssv plain_out, ssv cipher_in, ssv priv_key_in);
 void encrypt(ssv cipher_out, ssv plain_in, ssv pub_key_in);
-void keygen(ssv pub_out, ssv priv_out, mp_bitcnt_t len);
+void encrypt_stream(ssv cipher_out, ssv plain_in, ssv pub_key_in, Format format = Format::text);
+void keygen(ssv pub_out, ssv priv_out, mp_bitcnt_t len, bool short_exponent = false, unsigned s = 1);
 void keyseed(ssv pub_out, ssv priv_out, ssv seed_in);
 void mult_c(ssv cipher_result_out, ssv cipher_in, ssv constant_in, ssv pub_key_in);
 
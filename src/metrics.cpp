@@ -0,0 +1,237 @@
+#include <chrono>
+#include "metrics.hpp"
+#include <numeric>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace paillier::tools
+{
+
+static constexpr std::array<std::string_view, Metrics::operations> names{
+    "encrypt", "decrypt", "add", "mult", "crt_exponentiation", "prime", "io_read", "io_write"};
+
+/*
+ * Process wide operation counters. Every thread records into one of a fixed
+ * number of shards, picked round robin on its first call, so concurrent
+ * threads rarely write to the same cache lines. Readers sum all shards.
+ */
+Metrics &Metrics::get()
+{
+    static Metrics instance;
+    return instance;
+}
+
+std::size_t Metrics::shard()
+{
+    static std::atomic<std::size_t> threads{0};
+    static thread_local const std::size_t index{threads.fetch_add(1, std::memory_order_relaxed) % shards};
+    return index;
+}
+
+std::string_view Metrics::name(Operation operation)
+{
+    return names[static_cast<std::size_t>(operation)];
+}
+
+/*
+ * Time stamp counter on x86, nanoseconds of the steady clock elsewhere.
+ */
+std::uint64_t Metrics::cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*
+ * HDR style log-linear buckets: values below 2^sub_bits have a bucket each,
+ * larger values split every power of two into 2^sub_bits equal buckets.
+ */
+std::size_t Metrics::bucket(std::uint64_t cycles)
+{
+    if (cycles < (1U << sub_bits))
+    {
+        return cycles;
+    }
+
+    const unsigned top{63U - static_cast<unsigned>(__builtin_clzll(cycles))};
+    const std::size_t sub{(cycles >> (top - sub_bits)) & ((1U << sub_bits) - 1)};
+    return ((top - sub_bits + 1) << sub_bits) + sub;
+}
+
+/*
+ * Exclusive upper bound of the values in a bucket.
+ */
+std::uint64_t Metrics::bucket_limit(std::size_t index)
+{
+    if (index < (1U << sub_bits))
+    {
+        return index + 1;
+    }
+
+    const unsigned top{static_cast<unsigned>(index >> sub_bits) + sub_bits - 1};
+    const std::uint64_t sub{(index & ((1U << sub_bits) - 1)) + 1};
+    if (top == 63 && sub == (1U << sub_bits))
+    {
+        return UINT64_MAX;
+    }
+    return ((std::uint64_t{1} << sub_bits) + sub) << (top - sub_bits);
+}
+
+void Metrics::record(Operation operation, std::uint64_t cycles, std::uint64_t bytes)
+{
+    if (!enabled())
+    {
+        return;
+    }
+
+    Cell &cell{cells[shard()][static_cast<std::size_t>(operation)]};
+    cell.calls.fetch_add(1, std::memory_order_relaxed);
+    cell.cycles.fetch_add(cycles, std::memory_order_relaxed);
+    cell.histogram[bucket(cycles)].fetch_add(1, std::memory_order_relaxed);
+    if (bytes != 0)
+    {
+        cell.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+/*
+ * Sums the shards of one operation. Calls recorded concurrently may be
+ * partially included, the counters of each call are not read atomically.
+ */
+OperationStats Metrics::stats(Operation operation) const
+{
+    OperationStats result{operation, 0, 0, 0, std::vector<std::uint64_t>(buckets)};
+
+    for (const auto &shard : cells)
+    {
+        const Cell &cell{shard[static_cast<std::size_t>(operation)]};
+        result.calls += cell.calls.load(std::memory_order_relaxed);
+        result.cycles += cell.cycles.load(std::memory_order_relaxed);
+        result.bytes += cell.bytes.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < buckets; ++i)
+        {
+            result.histogram[i] += cell.histogram[i].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+void Metrics::reset()
+{
+    for (auto &shard : cells)
+    {
+        for (auto &cell : shard)
+        {
+            cell.calls.store(0, std::memory_order_relaxed);
+            cell.cycles.store(0, std::memory_order_relaxed);
+            cell.bytes.store(0, std::memory_order_relaxed);
+            for (auto &count : cell.histogram)
+            {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+/*
+ * Upper bound of the bucket holding the call of the given rank in percent,
+ * or 0 when nothing was recorded.
+ */
+std::uint64_t OperationStats::percentile(double rank) const
+{
+    const double target{rank / 100.0 * calls};
+    std::uint64_t seen{0};
+
+    for (std::size_t i = 0; i < histogram.size(); ++i)
+    {
+        seen += histogram[i];
+        if (seen != 0 && seen >= target)
+        {
+            return Metrics::bucket_limit(i);
+        }
+    }
+    return 0;
+}
+
+/*
+ * One object per operation with the totals, approximate percentiles and the
+ * non empty histogram buckets as [upper bound, calls] pairs.
+ */
+void Metrics::write_json(std::ostream &os) const
+{
+    os << "{\"operations\": [";
+    for (std::size_t op = 0; op < operations; ++op)
+    {
+        const OperationStats s{stats(static_cast<Operation>(op))};
+        os << (op == 0 ? "\n" : ",\n")
+           << "  {\"name\": \"" << names[op] << "\", \"calls\": " << s.calls << ", \"cycles\": " << s.cycles
+           << ", \"bytes\": " << s.bytes << ", \"p50\": " << s.percentile(50) << ", \"p90\": " << s.percentile(90)
+           << ", \"p99\": " << s.percentile(99) << ", \"max\": " << s.percentile(100) << ", \"histogram\": [";
+
+        bool first{true};
+        for (std::size_t i = 0; i < buckets; ++i)
+        {
+            if (s.histogram[i] != 0)
+            {
+                os << (first ? "" : ", ") << "[" << bucket_limit(i) << ", " << s.histogram[i] << "]";
+                first = false;
+            }
+        }
+        os << "]}";
+    }
+    os << "\n]}\n";
+}
+
+/*
+ * Prometheus text exposition. The histogram reports the power of two bucket
+ * bounds from 2^10 to 2^40 cycles, so the series stay the same between scrapes.
+ */
+void Metrics::write_prometheus(std::ostream &os) const
+{
+    std::array<OperationStats, operations> all{};
+    for (std::size_t op = 0; op < operations; ++op)
+    {
+        all[op] = stats(static_cast<Operation>(op));
+    }
+
+    const auto counter = [&](std::string_view metric, std::string_view help, std::uint64_t OperationStats::*field) {
+        os << "# HELP " << metric << " " << help << "\n"
+           << "# TYPE " << metric << " counter\n";
+        for (const auto &s : all)
+        {
+            os << metric << "{operation=\"" << name(s.operation) << "\"} " << s.*field << "\n";
+        }
+    };
+
+    counter("paillier_operation_calls_total", "Completed calls per operation.", &OperationStats::calls);
+    counter("paillier_operation_bytes_total", "Bytes read or written per operation.", &OperationStats::bytes);
+
+    os << "# HELP paillier_operation_cycles Cycles spent per call.\n"
+       << "# TYPE paillier_operation_cycles histogram\n";
+    for (const auto &s : all)
+    {
+        std::uint64_t below{0};
+        std::size_t i{0};
+        for (unsigned top = 10; top <= 40; ++top)
+        {
+            // buckets are aligned to powers of two, so each bound ends a run of whole buckets
+            for (; bucket_limit(i) <= (std::uint64_t{1} << top); ++i)
+            {
+                below += s.histogram[i];
+            }
+            os << "paillier_operation_cycles_bucket{operation=\"" << name(s.operation) << "\",le=\"" << (std::uint64_t{1} << top) << "\"} " << below << "\n";
+        }
+        // the total of the histogram, which may trail calls while other threads record
+        const std::uint64_t count{std::accumulate(s.histogram.begin(), s.histogram.end(), std::uint64_t{0})};
+        os << "paillier_operation_cycles_bucket{operation=\"" << name(s.operation) << "\",le=\"+Inf\"} " << count << "\n"
+           << "paillier_operation_cycles_sum{operation=\"" << name(s.operation) << "\"} " << s.cycles << "\n"
+           << "paillier_operation_cycles_count{operation=\"" << name(s.operation) << "\"} " << count << "\n";
+    }
+}
+
+} // paillier::tools
@@ -0,0 +1,149 @@
+#ifndef PAILLIER_METRICS_HPP
+#define PAILLIER_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+namespace paillier::tools
+{
+
+enum class Operation : std::size_t
+{
+    encrypt,
+    decrypt,
+    add,
+    mult,
+    crt_exponentiation,
+    prime,
+    io_read,
+    io_write
+};
+
+struct OperationStats
+{
+    Operation operation;
+    std::uint64_t calls, cycles, bytes;
+    // calls per latency bucket, see Metrics::bucket
+    std::vector<std::uint64_t> histogram;
+
+    std::uint64_t percentile(double rank) const;
+};
+
+class Metrics
+{
+  public:
+    static constexpr std::size_t operations = 8;
+    static constexpr std::size_t shards = 16;
+    // 8 linear sub-buckets per power of two bound the relative error to 12.5%
+    static constexpr unsigned sub_bits = 3;
+    static constexpr std::size_t buckets = (64 - sub_bits + 1) << sub_bits;
+
+  private:
+    struct alignas(64) Cell
+    {
+        std::atomic<std::uint64_t> calls, cycles, bytes;
+        std::array<std::atomic<std::uint64_t>, buckets> histogram;
+    };
+
+    // zero initialised, so the tables start out in untouched zero pages
+    std::array<std::array<Cell, operations>, shards> cells;
+    std::atomic<bool> disabled;
+
+    constexpr Metrics() : cells{}, disabled{false} {}
+
+    static std::size_t shard();
+
+  public:
+    Metrics(Metrics const &) = delete;
+    Metrics(Metrics &&) = delete;
+
+    static Metrics &get();
+    static std::string_view name(Operation operation);
+    static std::uint64_t cycles();
+    static std::size_t bucket(std::uint64_t cycles);
+    static std::uint64_t bucket_limit(std::size_t index);
+
+    bool enabled() const { return !disabled.load(std::memory_order_relaxed); }
+    void enable(bool enabled) { disabled.store(!enabled, std::memory_order_relaxed); }
+
+    void record(Operation operation, std::uint64_t cycles, std::uint64_t bytes = 0);
+    OperationStats stats(Operation operation) const;
+    void reset();
+
+    void write_json(std::ostream &os) const;
+    void write_prometheus(std::ostream &os) const;
+};
+
+/*
+ * Records one call of an operation, timed from construction to destruction.
+ */
+class OperationTimer
+{
+    Operation operation;
+    std::uint64_t start, bytes;
+
+  public:
+    explicit OperationTimer(Operation operation)
+        : operation(operation),
+          start(Metrics::get().enabled() ? Metrics::cycles() : 0),
+          bytes(0)
+    {
+    }
+    OperationTimer(OperationTimer const &) = delete;
+    OperationTimer(OperationTimer &&) = delete;
+
+    ~OperationTimer()
+    {
+        if (start != 0)
+        {
+            Metrics::get().record(operation, Metrics::cycles() - start, bytes);
+        }
+    }
+
+    void add_bytes(std::uint64_t count) { bytes += count; }
+};
+
+/*
+ * Records one io call together with the bytes it moved through a stream buffer.
+ * Buffers that cannot report their position, like pipes, count no bytes.
+ */
+class StreamTimer
+{
+    OperationTimer timer;
+    std::streambuf *buffer;
+    std::ios::openmode which;
+    std::streamoff start;
+
+    std::streamoff position() const
+    {
+        return buffer ? static_cast<std::streamoff>(buffer->pubseekoff(0, std::ios::cur, which)) : -1;
+    }
+
+  public:
+    StreamTimer(Operation operation, std::ios &stream, std::ios::openmode which)
+        : timer(operation),
+          buffer(stream.rdbuf()),
+          which(which),
+          start(position())
+    {
+    }
+    StreamTimer(StreamTimer const &) = delete;
+    StreamTimer(StreamTimer &&) = delete;
+
+    ~StreamTimer()
+    {
+        const std::streamoff end{position()};
+        if (start >= 0 && end > start)
+        {
+            timer.add_bytes(static_cast<std::uint64_t>(end - start));
+        }
+    }
+};
+
+} // paillier::tools
+
+#endif // PAILLIER_METRICS_HPP
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include "batch.hpp"
+#include "packing.hpp"
+#include <stdexcept>
+
+namespace paillier::impl
+{
+
+/*
+ * Slot-wise addition: the packed plaintexts add as integers, and since no slot
+ * may carry into the next one, the bound on slot values grows by one bit.
+ */
+PackedCipherText PackedCipherText::add(const PackedCipherText &other, const PublicContext &ctx) const
+{
+    if (other.slot_bits != slot_bits)
+    {
+        throw std::runtime_error("packed ciphertexts use different slot widths");
+    }
+
+    const mp_bitcnt_t bits{std::max(used_bits, other.used_bits) + 1};
+    if (bits > slot_bits)
+    {
+        throw std::runtime_error("packed addition would overflow the slot headroom");
+    }
+
+    return {cipher.add(other.cipher, ctx), std::max(count, other.count), slot_bits, bits};
+}
+
+/*
+ * Multiplies every slot by the same non negative scalar, growing the bound on
+ * slot values by the bit length of the scalar.
+ */
+PackedCipherText PackedCipherText::mult(const mpz_class &scalar, const PublicContext &ctx) const
+{
+    if (scalar < 0)
+    {
+        throw std::runtime_error("packed slots only take non negative scalars");
+    }
+
+    const mp_bitcnt_t bits{used_bits + (scalar == 0 ? 0 : mpz_sizeinbase(scalar.get_mpz_t(), 2))};
+    if (bits > slot_bits)
+    {
+        throw std::runtime_error("packed multiplication would overflow the slot headroom");
+    }
+
+    return {cipher.mult(scalar, ctx), count, slot_bits, bits};
+}
+
+/*
+ * Packs values of at most value_bits bits into slots of value_bits + headroom
+ * bits each. The headroom absorbs the carries of additions and scalar products,
+ * and as many slots fit into one plaintext as stay below n (n^s for keys of degree s).
+ */
+PackedEncoder::PackedEncoder(const key::Public &pub, mp_bitcnt_t value_bits, mp_bitcnt_t headroom)
+    : value_bits(value_bits),
+      headroom(headroom),
+      capacity((mpz_sizeinbase(mpz_class(pub.modulus() / pub.n).get_mpz_t(), 2) - 1) / (value_bits + headroom))
+{
+    if (value_bits == 0 || capacity == 0)
+    {
+        throw std::runtime_error("slot width does not fit the key");
+    }
+}
+
+/*
+ * Slot i of a plaintext holds value i of its group at bit offset i * slot_bits.
+ */
+std::vector<PlainText> PackedEncoder::encode(const std::vector<mpz_class> &values) const
+{
+    std::vector<PlainText> plains((values.size() + capacity - 1) / capacity);
+
+    for (std::size_t group = 0; group < plains.size(); ++group)
+    {
+        const std::size_t first{group * capacity},
+            last{std::min(first + capacity, values.size())};
+        mpz_class &packed{plains[group].text};
+
+        for (std::size_t i = last; i-- > first;)
+        {
+            if (values[i] < 0 || mpz_sizeinbase(values[i].get_mpz_t(), 2) > value_bits)
+            {
+                throw std::runtime_error("value does not fit its slot");
+            }
+            packed <<= slot_bits();
+            packed += values[i];
+        }
+    }
+
+    return plains;
+}
+
+std::vector<mpz_class> PackedEncoder::decode(const std::vector<PlainText> &plains, std::size_t count) const
+{
+    std::vector<mpz_class> values(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const mpz_class &packed{plains.at(i / capacity).text};
+        mpz_fdiv_q_2exp(values[i].get_mpz_t(), packed.get_mpz_t(), (i % capacity) * slot_bits());
+        mpz_fdiv_r_2exp(values[i].get_mpz_t(), values[i].get_mpz_t(), slot_bits());
+    }
+
+    return values;
+}
+
+std::vector<PackedCipherText> PackedEncoder::encrypt(const std::vector<mpz_class> &values, const PublicContext &ctx) const
+{
+    const std::vector<CipherText> ciphers{encrypt_batch(encode(values), ctx)};
+    std::vector<PackedCipherText> packed{};
+    packed.reserve(ciphers.size());
+
+    for (std::size_t group = 0; group < ciphers.size(); ++group)
+    {
+        const std::size_t count{std::min(capacity, values.size() - group * capacity)};
+        packed.push_back({ciphers[group], count, slot_bits(), value_bits});
+    }
+
+    return packed;
+}
+
+/*
+ * Decrypts packed ciphertexts and returns the values of all their slots in order.
+ */
+std::vector<mpz_class> PackedEncoder::decrypt(const std::vector<PackedCipherText> &ciphers, const key::Private &priv) const
+{
+    const std::vector<PlainText> plains{decrypt_batch(
+        ciphers.size(), [&ciphers](std::size_t i) { return ciphers[i].cipher.text; }, priv)};
+    std::vector<mpz_class> values{};
+
+    for (std::size_t group = 0; group < ciphers.size(); ++group)
+    {
+        if (ciphers[group].slot_bits != slot_bits())
+        {
+            throw std::runtime_error("packed ciphertext uses a different slot width");
+        }
+
+        const std::vector<mpz_class> slots{decode({plains[group]}, ciphers[group].count)};
+        values.insert(values.end(), slots.begin(), slots.end());
+    }
+
+    return values;
+}
+
+} // paillier::impl
@@ -0,0 +1,43 @@
+#ifndef PAILLIER_PACKING_HPP
+#define PAILLIER_PACKING_HPP
+
+#include <gmpxx.h>
+#include <impl.hpp>
+#include <vector>
+
+namespace paillier::impl
+{
+
+class PackedCipherText
+{
+public:
+  CipherText cipher;
+  // number of occupied slots, slot width and bits each slot value may already use
+  std::size_t count;
+  mp_bitcnt_t slot_bits, used_bits;
+
+  PackedCipherText add(const PackedCipherText &other, const PublicContext &ctx) const;
+  PackedCipherText mult(const mpz_class &scalar, const PublicContext &ctx) const;
+};
+
+class PackedEncoder
+{
+  mp_bitcnt_t value_bits, headroom;
+  std::size_t capacity;
+
+public:
+  PackedEncoder(const key::Public &pub, mp_bitcnt_t value_bits, mp_bitcnt_t headroom = 8);
+
+  std::size_t slots() const { return capacity; }
+  mp_bitcnt_t slot_bits() const { return value_bits + headroom; }
+
+  std::vector<PlainText> encode(const std::vector<mpz_class> &values) const;
+  std::vector<mpz_class> decode(const std::vector<PlainText> &plains, std::size_t count) const;
+
+  std::vector<PackedCipherText> encrypt(const std::vector<mpz_class> &values, const PublicContext &ctx) const;
+  std::vector<mpz_class> decrypt(const std::vector<PackedCipherText> &ciphers, const key::Private &priv) const;
+};
+
+} // paillier::impl
+
+#endif // PAILLIER_PACKING_HPP
@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "pool.hpp"
+#include <sstream>
+#include <stdexcept>
+#include "tools.hpp"
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace paillier::impl
+{
+
+/*
+ * Keeps a bounded ring of precomputed r^n mod n^2 values for the public key.
+ * The ring is refilled by `threads` background workers so that encryption
+ * only has to pay for a single modular multiplication.
+ */
+RandomnessPool::RandomnessPool(const key::Public &pub, std::size_t capacity, std::size_t threads)
+    : n(pub.n),
+      n2(pub.n * pub.n),
+      capacity(capacity == 0 ? 1 : capacity),
+      ring(this->capacity),
+      head(0),
+      count(0),
+      stopping(false)
+{
+    if (pub.s != 1)
+    {
+        throw std::runtime_error("randomness pools only serve Paillier keys");
+    }
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(&RandomnessPool::refill, this);
+    }
+}
+
+RandomnessPool::~RandomnessPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    drained.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+/*
+ * Computes r^n mod n^2 for a fresh r relatively prime to n.
+ */
+mpz_class RandomnessPool::draw() const
+{
+    mpz_class result{};
+    const mpz_class r{tools::Random::get().relatively_prime(n)};
+    mpz_powm(result.get_mpz_t(), r.get_mpz_t(), n.get_mpz_t(), n2.get_mpz_t());
+    return result;
+}
+
+/*
+ * Worker loop: the exponentiation runs outside the lock, the worker then
+ * sleeps until there is room in the ring for its value.
+ */
+void RandomnessPool::refill()
+{
+    for (;;)
+    {
+        mpz_class value{draw()};
+        std::unique_lock<std::mutex> guard(lock);
+        drained.wait(guard, [this] { return stopping || count < capacity; });
+        if (stopping)
+        {
+            return;
+        }
+        ring[(head + count) % capacity].swap(value);
+        ++count;
+    }
+}
+
+std::size_t RandomnessPool::available()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return count;
+}
+
+/*
+ * Hands out one precomputed value. An empty ring falls back to computing the
+ * value on the caller's thread instead of waiting on a worker.
+ */
+mpz_class RandomnessPool::take()
+{
+    mpz_class value{};
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (count > 0)
+        {
+            value.swap(ring[head]);
+            head = (head + 1) % capacity;
+            --count;
+        }
+    }
+
+    if (value == 0U)
+    {
+        return draw();
+    }
+
+    drained.notify_one();
+    return value;
+}
+
+/*
+ * Key generation confined to the calling thread. Pool workers run at low
+ * priority and must not hand their prime searches to the shared executor.
+ */
+static std::pair<key::Private, key::Public> generate(const mp_bitcnt_t k, const bool short_exponent)
+{
+    tools::Random &random{tools::Random::get()};
+    mpz_class p{random.prime(k / 2)}, q{random.prime(k / 2)};
+
+    while (p == q)
+    {
+        q = random.prime(k / 2);
+    }
+    if (p > q)
+    {
+        p.swap(q);
+    }
+
+    auto keys = key::seed(k, p, q);
+    if (short_exponent)
+    {
+        keys.second = key::with_short_exponent(keys.second);
+    }
+    return keys;
+}
+
+/*
+ * XORs data with the ChaCha20 key stream of the spool key and nonce.
+ */
+static void apply_stream(std::string &data, const std::array<std::uint8_t, 32> &key, const std::array<std::uint8_t, 12> &nonce)
+{
+    std::vector<std::uint8_t> stream(data.size());
+    tools::ChaCha20(key, nonce).fill(stream.data(), stream.size());
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<char>(static_cast<std::uint8_t>(data[i]) ^ stream[i]);
+    }
+}
+
+/*
+ * Keeps up to capacity fresh key pairs for each of the given sizes, generated
+ * by background workers running at the lowest scheduling priority.
+ */
+KeyPool::KeyPool(const std::vector<mp_bitcnt_t> &sizes, std::size_t capacity, std::size_t threads, bool short_exponent)
+    : KeyPool(sizes, {}, {}, capacity, threads, short_exponent)
+{
+}
+
+/*
+ * Same as above, with every pair also kept in a spool directory until it is
+ * handed out, so that a restarted pool starts with the pairs of its
+ * predecessor. Each spool file holds a random 12 byte nonce followed by the
+ * text form of the pair encrypted with ChaCha20 under spool_key.
+ * The files are encrypted only, not authenticated: the spool directory must
+ * not be writable by untrusted parties.
+ */
+KeyPool::KeyPool(const std::vector<mp_bitcnt_t> &sizes,
+                 const std::string &spool,
+                 const std::array<std::uint8_t, 32> &spool_key,
+                 std::size_t capacity,
+                 std::size_t threads,
+                 bool short_exponent)
+    : capacity(capacity == 0 ? 1 : capacity),
+      short_exponent(short_exponent),
+      spool(spool),
+      spool_key(spool_key),
+      stopping(false)
+{
+    for (const mp_bitcnt_t k : sizes)
+    {
+        buckets[k].pending = 0;
+    }
+
+    if (!spool.empty())
+    {
+        std::filesystem::create_directories(spool);
+        load();
+    }
+
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(&KeyPool::refill, this);
+    }
+}
+
+KeyPool::~KeyPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    drained.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+/*
+ * Picks up the spooled pairs of the pooled sizes. Files that do not decrypt
+ * to a key pair, for example those of another spool key, are left alone.
+ */
+void KeyPool::load()
+{
+    for (const auto &file : std::filesystem::directory_iterator(spool))
+    {
+        if (file.path().extension() != ".key")
+        {
+            continue;
+        }
+
+        std::ifstream in(file.path(), std::ios::binary);
+        std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        std::array<std::uint8_t, 12> nonce{};
+        if (data.size() <= nonce.size())
+        {
+            continue;
+        }
+
+        std::copy_n(data.begin(), nonce.size(), nonce.begin());
+        data.erase(0, nonce.size());
+        apply_stream(data, spool_key, nonce);
+
+        Entry entry{{}, file.path().string()};
+        std::istringstream text{data};
+        text >> entry.keys.first >> entry.keys.second;
+        if (entry.keys.second.n == 0U || entry.keys.first.n != entry.keys.second.n ||
+            (entry.keys.second.hs != 0U) != short_exponent)
+        {
+            continue;
+        }
+
+        const auto bucket = buckets.find(entry.keys.second.k);
+        if (bucket != buckets.end())
+        {
+            bucket->second.ready.push_back(std::move(entry));
+        }
+    }
+}
+
+/*
+ * Writes a pair to a new spool file and returns its path. The file is
+ * written under a temporary name and renamed, so it is never seen partially.
+ */
+std::string KeyPool::save(const std::pair<key::Private, key::Public> &keys) const
+{
+    std::array<std::uint8_t, 12> nonce{};
+    const mpz_class id{tools::Random::get().bits(64)}, bits{tools::Random::get().bits(96)};
+    mpz_export(nonce.data(), nullptr, -1, 1, 0, 0, bits.get_mpz_t());
+
+    std::ostringstream text{};
+    text << keys.first << "\n"
+         << keys.second << "\n";
+    std::string data{text.str()};
+    apply_stream(data, spool_key, nonce);
+
+    const std::filesystem::path path{std::filesystem::path(spool) / (std::to_string(keys.second.k) + "-" + id.get_str(16) + ".key")};
+    std::filesystem::path partial{path};
+    partial += ".tmp";
+    {
+        std::ofstream out(partial, std::ios::binary);
+        out.write(reinterpret_cast<const char *>(nonce.data()), nonce.size());
+        out.write(data.data(), data.size());
+        if (!out)
+        {
+            throw std::runtime_error("cannot write key spool file " + partial.string());
+        }
+    }
+    std::filesystem::rename(partial, path);
+
+    return path.string();
+}
+
+/*
+ * Worker loop: tops up the size with the fewest ready and pending pairs.
+ * Generation and spooling run outside the lock.
+ */
+void KeyPool::refill()
+{
+#if defined(__linux__)
+    // background generation should not compete with the callers of the library
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+
+    for (;;)
+    {
+        mp_bitcnt_t k{0};
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            drained.wait(guard, [this, &k] {
+                std::size_t fewest{capacity};
+                for (const auto &[size, bucket] : buckets)
+                {
+                    if (bucket.ready.size() + bucket.pending < fewest)
+                    {
+                        fewest = bucket.ready.size() + bucket.pending;
+                        k = size;
+                    }
+                }
+                return stopping || fewest < capacity;
+            });
+            if (stopping)
+            {
+                return;
+            }
+            ++buckets[k].pending;
+        }
+
+        Entry entry{};
+        try
+        {
+            entry.keys = generate(k, short_exponent);
+        }
+        catch (const std::exception &)
+        {
+            // give the slot back and retry after a pause instead of spinning on the failure
+            std::unique_lock<std::mutex> guard(lock);
+            --buckets[k].pending;
+            if (drained.wait_for(guard, std::chrono::seconds{1}, [this] { return stopping; }))
+            {
+                return;
+            }
+            continue;
+        }
+
+        if (!spool.empty())
+        {
+            try
+            {
+                entry.path = save(entry.keys);
+            }
+            catch (const std::exception &)
+            {
+                // an unwritable spool only costs persistence, the pair is still served from memory
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        --buckets[k].pending;
+        buckets[k].ready.push_back(std::move(entry));
+    }
+}
+
+std::size_t KeyPool::available(mp_bitcnt_t k)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    const auto bucket = buckets.find(k);
+    return bucket == buckets.end() ? 0 : bucket->second.ready.size();
+}
+
+/*
+ * Hands out one pregenerated pair after claiming its spool file. Sizes that
+ * are not pooled, have run dry or whose file was already claimed are
+ * generated on the caller's thread instead.
+ */
+std::pair<key::Private, key::Public> KeyPool::take(mp_bitcnt_t k)
+{
+    Entry entry{};
+    bool found{false};
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        const auto bucket = buckets.find(k);
+        if (bucket != buckets.end() && !bucket->second.ready.empty())
+        {
+            entry = std::move(bucket->second.ready.front());
+            bucket->second.ready.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        return key::gen(k, short_exponent);
+    }
+
+    // the pair is only served once its spool file is unlinked, so neither a
+    // restarted pool nor another pool on the same spool can serve it again
+    drained.notify_one();
+    if (!entry.path.empty())
+    {
+        std::error_code error{};
+        if (!std::filesystem::remove(entry.path, error) || error)
+        {
+            return key::gen(k, short_exponent);
+        }
+    }
+    return std::move(entry.keys);
+}
+
+} // paillier::impl
@@ -0,0 +1,92 @@
+#ifndef PAILLIER_POOL_HPP
+#define PAILLIER_POOL_HPP
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <gmpxx.h>
+#include <impl.hpp>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace paillier::impl
+{
+
+class RandomnessPool
+{
+  const mpz_class n, n2;
+  const std::size_t capacity;
+  std::vector<mpz_class> ring;
+  std::size_t head, count;
+  bool stopping;
+  std::mutex lock;
+  std::condition_variable drained;
+  std::vector<std::thread> workers;
+
+  mpz_class draw() const;
+  void refill();
+
+public:
+  RandomnessPool(const key::Public &pub, std::size_t capacity = 64, std::size_t threads = 1);
+  RandomnessPool(RandomnessPool const &) = delete;
+  RandomnessPool(RandomnessPool &&) = delete;
+  ~RandomnessPool();
+
+  const mpz_class &modulus() const { return n; }
+  std::size_t available();
+  mpz_class take();
+};
+
+class KeyPool
+{
+  struct Entry
+  {
+    std::pair<key::Private, key::Public> keys;
+    // spool file holding the pair, empty when the pool keeps no spool
+    std::string path;
+  };
+
+  struct Bucket
+  {
+    std::deque<Entry> ready;
+    std::size_t pending;
+  };
+
+  const std::size_t capacity;
+  const bool short_exponent;
+  const std::string spool;
+  const std::array<std::uint8_t, 32> spool_key;
+  std::map<mp_bitcnt_t, Bucket> buckets;
+  bool stopping;
+  std::mutex lock;
+  std::condition_variable drained;
+  std::vector<std::thread> workers;
+
+  void load();
+  std::string save(const std::pair<key::Private, key::Public> &keys) const;
+  void refill();
+
+public:
+  KeyPool(const std::vector<mp_bitcnt_t> &sizes, std::size_t capacity = 4, std::size_t threads = 1, bool short_exponent = false);
+  KeyPool(const std::vector<mp_bitcnt_t> &sizes,
+          const std::string &spool,
+          const std::array<std::uint8_t, 32> &spool_key,
+          std::size_t capacity = 4,
+          std::size_t threads = 1,
+          bool short_exponent = false);
+  KeyPool(KeyPool const &) = delete;
+  KeyPool(KeyPool &&) = delete;
+  ~KeyPool();
+
+  std::size_t available(mp_bitcnt_t k);
+  std::pair<key::Private, key::Public> take(mp_bitcnt_t k);
+};
+
+} // paillier::impl
+
+#endif // PAILLIER_POOL_HPP
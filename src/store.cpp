@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <fcntl.h>
+#include "metrics.hpp"
+#include <stdexcept>
+#include "store.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace paillier::io
+{
+
+// records are mapped straight into mpz views, so limbs must match the on-disk words
+static_assert(GMP_NUMB_BITS == 64 && sizeof(mp_limb_t) == 8, "store records need 64-bit GMP limbs");
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "store records are little-endian");
+
+/*
+ * Ciphertext file in the binary format of write_ciphers, mapped into memory.
+ * Records have a fixed width, so element i lives at a known offset and is read
+ * in place through a CipherTextView. Appending may remap the file, which
+ * invalidates views and slices taken before.
+ */
+CipherTextStore::CipherTextStore(std::string path, int fd, bool writable)
+    : path(std::move(path)),
+      fd(fd),
+      writable(writable),
+      map(nullptr),
+      mapped(0),
+      header{}
+{
+    try
+    {
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < Header::size)
+        {
+            throw std::runtime_error("ciphertext store is too short: " + this->path);
+        }
+
+        remap(static_cast<std::size_t>(info.st_size));
+        header = Header::parse(map);
+
+        if (header.kind != Kind::ciphers || header.limbs == 0)
+        {
+            throw std::runtime_error("not a ciphertext store: " + this->path);
+        }
+        if (capacity() < header.count)
+        {
+            throw std::runtime_error("truncated ciphertext store: " + this->path);
+        }
+    }
+    catch (...)
+    {
+        if (map)
+        {
+            munmap(map, mapped);
+        }
+        close(fd);
+        throw;
+    }
+}
+
+CipherTextStore::CipherTextStore(CipherTextStore &&other) noexcept
+    : path(std::move(other.path)),
+      fd(other.fd),
+      writable(other.writable),
+      map(other.map),
+      mapped(other.mapped),
+      header(other.header)
+{
+    other.fd = -1;
+    other.map = nullptr;
+    other.mapped = 0;
+}
+
+CipherTextStore::~CipherTextStore()
+{
+    if (map)
+    {
+        munmap(map, mapped);
+    }
+    if (fd >= 0)
+    {
+        if (writable)
+        {
+            // drop the spare capacity reserved by append; a failure only leaves unused records behind
+            const int trimmed{ftruncate(fd, Header::size + header.count * header.limbs * sizeof(mp_limb_t))};
+            static_cast<void>(trimmed);
+        }
+        close(fd);
+    }
+}
+
+/*
+ * Creates an empty store for ciphertexts of the given key, replacing any existing file.
+ */
+CipherTextStore CipherTextStore::create(const std::string &path, const impl::key::Public &pub)
+{
+    const int fd{::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)};
+    if (fd < 0)
+    {
+        throw std::runtime_error("cannot create ciphertext store: " + path);
+    }
+
+    const auto bytes = Header{Header::current, Kind::ciphers, io::fingerprint(pub.n), limbs(pub.modulus()), 0}.serialize();
+    if (write(fd, bytes.data(), bytes.size()) != static_cast<ssize_t>(bytes.size()))
+    {
+        close(fd);
+        throw std::runtime_error("cannot write ciphertext store: " + path);
+    }
+
+    return CipherTextStore{path, fd, true};
+}
+
+CipherTextStore CipherTextStore::open(const std::string &path, bool writable)
+{
+    const int fd{::open(path.c_str(), writable ? O_RDWR : O_RDONLY)};
+    if (fd < 0)
+    {
+        throw std::runtime_error("cannot open ciphertext store: " + path);
+    }
+    return CipherTextStore{path, fd, writable};
+}
+
+/*
+ * Opens a store and checks that it holds ciphertexts of the given key.
+ */
+CipherTextStore CipherTextStore::open(const std::string &path, const impl::key::Public &pub, bool writable)
+{
+    CipherTextStore store{open(path, writable)};
+    if (store.fingerprint() != io::fingerprint(pub.n))
+    {
+        throw std::runtime_error("ciphertext store was written for a different key: " + path);
+    }
+    return store;
+}
+
+void CipherTextStore::remap(std::size_t bytes)
+{
+    if (map)
+    {
+        munmap(map, mapped);
+        map = nullptr;
+        mapped = 0;
+    }
+
+    const int protection{writable ? PROT_READ | PROT_WRITE : PROT_READ};
+    void *memory{mmap(nullptr, bytes, protection, MAP_SHARED, fd, 0)};
+    if (memory == MAP_FAILED)
+    {
+        throw std::runtime_error("cannot map ciphertext store: " + path);
+    }
+
+    map = static_cast<std::uint8_t *>(memory);
+    mapped = bytes;
+}
+
+void CipherTextStore::sync_header()
+{
+    const auto bytes = header.serialize();
+    std::copy(bytes.begin(), bytes.end(), map);
+}
+
+std::size_t CipherTextStore::capacity() const
+{
+    return (mapped - Header::size) / (header.limbs * sizeof(mp_limb_t));
+}
+
+const mp_limb_t *CipherTextStore::row(std::size_t i) const
+{
+    return reinterpret_cast<const mp_limb_t *>(map + Header::size) + i * header.limbs;
+}
+
+impl::CipherTextView CipherTextStore::at(std::size_t i) const
+{
+    if (i >= header.count)
+    {
+        throw std::runtime_error("ciphertext store index out of range");
+    }
+    return (*this)[i];
+}
+
+/*
+ * Zero-copy view of the ciphertexts [first, last).
+ */
+CipherTextSlice CipherTextStore::slice(std::size_t first, std::size_t last) const
+{
+    if (first > last || last > header.count)
+    {
+        throw std::runtime_error("ciphertext store slice out of range");
+    }
+    return {row(first), width(), last - first};
+}
+
+void CipherTextStore::append(const impl::CipherText &cipher)
+{
+    append(std::vector<impl::CipherText>{cipher});
+}
+
+/*
+ * Appends ciphertexts, growing the file geometrically so that repeated
+ * appends remap it only a logarithmic number of times.
+ */
+void CipherTextStore::append(const std::vector<impl::CipherText> &ciphers)
+{
+    tools::OperationTimer timer{tools::Operation::io_write};
+    if (!writable)
+    {
+        throw std::runtime_error("ciphertext store is read only: " + path);
+    }
+
+    // every record is checked before the file grows, so a rejected batch leaves the store unchanged
+    for (const auto &cipher : ciphers)
+    {
+        if (cipher.text < 0 || mpz_size(cipher.text.get_mpz_t()) > header.limbs)
+        {
+            throw std::runtime_error("ciphertext does not fit the store records");
+        }
+    }
+
+    const std::size_t needed{header.count + ciphers.size()};
+    if (needed > capacity())
+    {
+        const std::size_t rows{std::max({needed, 2 * capacity(), std::size_t{16}})};
+        const std::size_t bytes{Header::size + rows * header.limbs * sizeof(mp_limb_t)};
+        if (ftruncate(fd, bytes) != 0)
+        {
+            throw std::runtime_error("cannot grow ciphertext store: " + path);
+        }
+        remap(bytes);
+    }
+
+    for (std::size_t i = 0; i < ciphers.size(); ++i)
+    {
+        const mpz_srcptr value{ciphers[i].text.get_mpz_t()};
+        const std::size_t size{mpz_size(value)};
+        mp_limb_t *record{const_cast<mp_limb_t *>(row(header.count + i))};
+        std::copy_n(mpz_limbs_read(value), size, record);
+        std::fill(record + size, record + header.limbs, mp_limb_t{0});
+    }
+    header.count = needed;
+    sync_header();
+    timer.add_bytes(ciphers.size() * header.limbs * sizeof(mp_limb_t));
+}
+
+void CipherTextStore::flush()
+{
+    if (map && msync(map, mapped, MS_SYNC) != 0)
+    {
+        throw std::runtime_error("cannot flush ciphertext store: " + path);
+    }
+}
+
+} // paillier::io
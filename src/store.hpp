@@ -0,0 +1,70 @@
+#ifndef PAILLIER_STORE_HPP
+#define PAILLIER_STORE_HPP
+
+#include <arena.hpp>
+#include <gmpxx.h>
+#include <impl.hpp>
+#include <io.hpp>
+#include <string>
+#include <vector>
+
+namespace paillier::io
+{
+
+class CipherTextSlice
+{
+  const mp_limb_t *limbs;
+  mp_size_t stride;
+  std::size_t count;
+
+public:
+  CipherTextSlice(const mp_limb_t *limbs, mp_size_t stride, std::size_t count)
+      : limbs(limbs), stride(stride), count(count)
+  {
+  }
+
+  std::size_t size() const { return count; }
+  const mp_limb_t *row(std::size_t i) const { return limbs + i * stride; }
+  impl::CipherTextView operator[](std::size_t i) const { return {row(i), stride}; }
+};
+
+class CipherTextStore
+{
+  std::string path;
+  int fd;
+  bool writable;
+  std::uint8_t *map;
+  std::size_t mapped;
+  Header header;
+
+  void remap(std::size_t bytes);
+  void sync_header();
+  std::size_t capacity() const;
+
+  CipherTextStore(std::string path, int fd, bool writable);
+
+public:
+  CipherTextStore(CipherTextStore const &) = delete;
+  CipherTextStore(CipherTextStore &&other) noexcept;
+  ~CipherTextStore();
+
+  static CipherTextStore create(const std::string &path, const impl::key::Public &pub);
+  static CipherTextStore open(const std::string &path, bool writable = false);
+  static CipherTextStore open(const std::string &path, const impl::key::Public &pub, bool writable = false);
+
+  std::size_t size() const { return header.count; }
+  mp_size_t width() const { return header.limbs; }
+  std::uint64_t fingerprint() const { return header.fingerprint; }
+  const mp_limb_t *row(std::size_t i) const;
+  impl::CipherTextView operator[](std::size_t i) const { return {row(i), width()}; }
+  impl::CipherTextView at(std::size_t i) const;
+  CipherTextSlice slice(std::size_t first, std::size_t last) const;
+
+  void append(const impl::CipherText &cipher);
+  void append(const std::vector<impl::CipherText> &ciphers);
+  void flush();
+};
+
+} // paillier::io
+
+#endif // PAILLIER_STORE_HPP
@@ -0,0 +1,210 @@
+#include "batch.hpp"
+#include "executor.hpp"
+#include <fstream>
+#include "io.hpp"
+#include "metrics.hpp"
+#include <stdexcept>
+
+namespace paillier::io
+{
+
+/*
+ * Runs compute over consecutive chunks returned by parse, writing each result
+ * with emit in input order. The next chunk is parsed while the current one is
+ * computed on the executor, so at most one chunk is in flight and memory stays
+ * bounded by about two chunks regardless of the stream length.
+ */
+template <typename Parse, typename Compute, typename Emit>
+static void pipeline(Parse parse, Compute compute, Emit emit)
+{
+    auto input = parse();
+    while (!input.empty())
+    {
+        auto result = tools::async(compute, std::move(input));
+
+        try
+        {
+            input = parse();
+        }
+        catch (...)
+        {
+            // the task refers to the caller's key, so it has to finish before unwinding
+            tools::await(result);
+            throw;
+        }
+
+        emit(tools::await(result));
+    }
+}
+
+/*
+ * Encrypts whitespace separated plaintexts chunk by chunk. Binary output needs a
+ * seekable stream, since the record count is patched into the header at the end.
+ */
+void encrypt_stream(std::istream &plains, std::ostream &ciphers, const impl::key::Public &pub, Format format, std::size_t chunk)
+{
+    if (chunk == 0)
+    {
+        throw std::runtime_error("stream chunks must hold at least one value");
+    }
+
+    const impl::PublicContext ctx{pub};
+    const std::uint32_t width{limbs(ctx.n2)};
+    const std::streampos start{ciphers.tellp()};
+    std::uint64_t count{0};
+
+    Header header{Header::current, Kind::ciphers, fingerprint(pub.n), width, 0};
+    if (format == Format::binary)
+    {
+        if (start == std::streampos(-1))
+        {
+            throw std::runtime_error("binary ciphertext streams must be seekable");
+        }
+        const auto bytes = header.serialize();
+        ciphers.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    }
+
+    std::vector<std::uint8_t> record(8 * std::size_t{width});
+    pipeline(
+        [&]() {
+            const tools::StreamTimer timer{tools::Operation::io_read, plains, std::ios::in};
+            std::vector<impl::PlainText> input{};
+            impl::PlainText p{};
+            while (input.size() < chunk && plains >> p)
+            {
+                input.push_back(p);
+            }
+            if (input.size() < chunk && !plains.eof())
+            {
+                throw std::runtime_error("malformed plaintext in stream");
+            }
+            return input;
+        },
+        [&ctx](const std::vector<impl::PlainText> &input) { return impl::encrypt_batch(input, ctx); },
+        [&](const std::vector<impl::CipherText> &output) {
+            const tools::StreamTimer timer{tools::Operation::io_write, ciphers, std::ios::out};
+            for (const auto &c : output)
+            {
+                if (format == Format::binary)
+                {
+                    export_limbs(record.data(), c.text, width);
+                    ciphers.write(reinterpret_cast<const char *>(record.data()), record.size());
+                }
+                else
+                {
+                    ciphers << c << "\n";
+                }
+            }
+            count += output.size();
+        });
+
+    if (format == Format::binary)
+    {
+        const std::streampos end{ciphers.tellp()};
+        header.count = count;
+        const auto bytes = header.serialize();
+        ciphers.seekp(start);
+        ciphers.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        ciphers.seekp(end);
+    }
+    ciphers.flush();
+}
+
+/*
+ * Decrypts a text or binary ciphertext stream chunk by chunk, one plaintext per line.
+ */
+void decrypt_stream(std::istream &ciphers, std::ostream &plains, const impl::key::Private &priv, std::size_t chunk)
+{
+    if (chunk == 0)
+    {
+        throw std::runtime_error("stream chunks must hold at least one value");
+    }
+
+    const Format format{detect(ciphers)};
+    Header header{};
+
+    if (format == Format::binary)
+    {
+        // records of a stream are exactly as wide as the ciphertexts mod n^(s+1)
+        mpz_class modulus{};
+        mpz_pow_ui(modulus.get_mpz_t(), priv.n.get_mpz_t(), priv.s + 1);
+
+        header = read_header(ciphers, Kind::ciphers);
+        if (header.fingerprint != fingerprint(priv.n))
+        {
+            throw std::runtime_error("stream does not hold ciphertexts of this key");
+        }
+        if (header.limbs != limbs(modulus))
+        {
+            throw std::runtime_error("ciphertext records do not match the width of this key");
+        }
+    }
+
+    std::vector<std::uint8_t> record(8 * std::size_t{header.limbs});
+    pipeline(
+        [&]() {
+            const tools::StreamTimer timer{tools::Operation::io_read, ciphers, std::ios::in};
+            std::vector<impl::CipherText> input{};
+            impl::CipherText c{};
+            if (format == Format::text)
+            {
+                while (input.size() < chunk && ciphers >> c)
+                {
+                    input.push_back(c);
+                }
+                if (input.size() < chunk && !ciphers.eof())
+                {
+                    throw std::runtime_error("malformed ciphertext in stream");
+                }
+                return input;
+            }
+
+            while (input.size() < chunk && header.count > 0)
+            {
+                if (!ciphers.read(reinterpret_cast<char *>(record.data()), record.size()))
+                {
+                    throw std::runtime_error("truncated binary paillier file");
+                }
+                import_limbs(c.text, record.data(), header.limbs);
+                input.push_back(c);
+                --header.count;
+            }
+            return input;
+        },
+        [&priv](const std::vector<impl::CipherText> &input) { return impl::decrypt_batch(input, priv); },
+        [&](const std::vector<impl::PlainText> &output) {
+            const tools::StreamTimer timer{tools::Operation::io_write, plains, std::ios::out};
+            for (const auto &p : output)
+            {
+                plains << p << "\n";
+            }
+        });
+
+    plains.flush();
+}
+
+void decrypt_stream(ssv plain_out, ssv cipher_in, ssv priv_key_in)
+{
+    impl::key::Private priv{};
+
+    std::fstream priv_key(priv_key_in.data(), priv_key.in);
+    std::fstream cipher(cipher_in.data(), cipher.in | cipher.binary);
+    std::fstream plain(plain_out.data(), plain.out);
+
+    read_key(priv_key, priv);
+    decrypt_stream(cipher, plain, priv);
+}
+
+void encrypt_stream(ssv cipher_out, ssv plain_in, ssv pub_key_in, Format format)
+{
+    impl::key::Public pub{};
+
+    std::fstream pub_key(pub_key_in.data(), pub_key.in);
+    std::fstream plain(plain_in.data(), plain.in);
+    std::fstream cipher(cipher_out.data(), cipher.out | cipher.binary);
+
+    read_key(pub_key, pub);
+    encrypt_stream(plain, cipher, pub, format);
+}
+
+} // paillier::io
@@ -1,8 +1,20 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include "executor.hpp"
 #include <future>
 #include <iostream>
+#include "metrics.hpp"
+#include <mutex>
 #include <random>
+#include <stdexcept>
 #include "tools.hpp"
 
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/random.h>
+#endif
+
 namespace paillier::tools
 {
 
@@ -13,6 +25,22 @@ inline void debug_msg(std::string_view msg)
 #endif
 }
 
+/*
+ * Garner's recombination of residues rp mod p and rq mod q into the residue mod p*q:
+ *
+ * y = rp + p*((rq-rp)*(p^{-1} mod q) mod q)
+ */
+mpz_class crt_combine(const mpz_class rp,
+                      const mpz_class rq,
+                      const mpz_class pinvq,
+                      const mpz_class p,
+                      const mpz_class q)
+{
+    mpz_class result{(rq - rp) * pinvq};
+    mpz_mod(result.get_mpz_t(), result.get_mpz_t(), q.get_mpz_t());
+    return rp + result * p;
+}
+
 /*
  * The exponentiation is computed using Garner's method for the CRT:
  * 
@@ -22,7 +50,7 @@ inline void debug_msg(std::string_view msg)
  * 
  * NOTE: p MUST be greater than q
  * 
- * The exponentiations mod p and mod q may run in their own thread.
+ * The exponentiation mod p is handed to the executor while the caller computes the one mod q.
  */
 mpz_class crt_exponentiation(const mpz_class base,
                              const mpz_class exp_p,
@@ -31,6 +59,7 @@ mpz_class crt_exponentiation(const mpz_class base,
                              const mpz_class p,
                              const mpz_class q)
 {
+    const OperationTimer timer{Operation::crt_exponentiation};
     static const auto exponentiate = [](const mpz_class basis, const mpz_class exponent, const mpz_class modulus) {
         mpz_class result{};
         mpz_class basis_reduced{basis % modulus};
@@ -38,40 +67,699 @@ mpz_class crt_exponentiation(const mpz_class base,
         return result;
     };
 
-    std::future<mpz_class> f_rp = std::async(exponentiate, base, exp_p, p);
-    std::future<mpz_class> f_rq = std::async(exponentiate, base, exp_q, q);
+    std::future<mpz_class> f_rp = async(exponentiate, base, exp_p, p);
+    const mpz_class rq{exponentiate(base, exp_q, q)};
+
+    return crt_combine(await(f_rp), rq, pinvq, p, q);
+}
+
+static void mul_mod(mpz_class &result, mpz_srcptr factor, const mpz_class &modulus)
+{
+    mpz_mul(result.get_mpz_t(), result.get_mpz_t(), factor);
+    mpz_mod(result.get_mpz_t(), result.get_mpz_t(), modulus.get_mpz_t());
+}
+
+static std::size_t window(mpz_srcptr exp, const mp_bitcnt_t first, const unsigned width)
+{
+    std::size_t digit{0};
+    for (unsigned bit = width; bit-- > 0;)
+    {
+        digit = (digit << 1) | static_cast<std::size_t>(mpz_tstbit(exp, first + bit));
+    }
+    return digit;
+}
+
+/*
+ * Straus' interleaved exponentiation: every base gets a table of its first 2^width powers,
+ * and one shared chain of squarings walks all exponents window by window.
+ */
+static mpz_class straus(const std::vector<mpz_srcptr> &bases,
+                        const std::vector<mpz_srcptr> &exps,
+                        const mpz_class &modulus,
+                        const mp_bitcnt_t bits,
+                        const unsigned width)
+{
+    const std::size_t size{std::size_t{1} << width};
+    std::vector<mpz_class> tables(bases.size() * size);
+
+    for (std::size_t i = 0; i < bases.size(); ++i)
+    {
+        mpz_class *table{&tables[i * size]};
+        table[0] = 1U;
+        mpz_mod(table[1].get_mpz_t(), bases[i], modulus.get_mpz_t());
+        for (std::size_t d = 2; d < size; ++d)
+        {
+            table[d] = table[d - 1];
+            mul_mod(table[d], table[1].get_mpz_t(), modulus);
+        }
+    }
+
+    mpz_class result{1U};
+    for (mp_bitcnt_t w = (bits + width - 1) / width; w-- > 0;)
+    {
+        for (unsigned s = 0; s < width && result != 1U; ++s)
+        {
+            mul_mod(result, result.get_mpz_t(), modulus);
+        }
+        for (std::size_t i = 0; i < bases.size(); ++i)
+        {
+            const std::size_t digit{window(exps[i], w * width, width)};
+            if (digit != 0)
+            {
+                mul_mod(result, tables[i * size + digit].get_mpz_t(), modulus);
+            }
+        }
+    }
+
+    return result;
+}
+
+/*
+ * Pippenger's bucket method: for each window every base is multiplied into the bucket of
+ * its digit, and the buckets are folded with a running product so that bucket d ends up
+ * raised to the power d. Costs about one multiplication per base and window.
+ */
+static mpz_class pippenger(const std::vector<mpz_srcptr> &bases,
+                           const std::vector<mpz_srcptr> &exps,
+                           const mpz_class &modulus,
+                           const mp_bitcnt_t bits,
+                           const unsigned width)
+{
+    const std::size_t size{std::size_t{1} << width};
+    std::vector<mpz_class> buckets(size);
+    std::vector<bool> used(size);
+
+    mpz_class result{1U};
+    for (mp_bitcnt_t w = (bits + width - 1) / width; w-- > 0;)
+    {
+        for (unsigned s = 0; s < width && result != 1U; ++s)
+        {
+            mul_mod(result, result.get_mpz_t(), modulus);
+        }
+
+        std::fill(used.begin(), used.end(), false);
+        for (std::size_t i = 0; i < bases.size(); ++i)
+        {
+            const std::size_t digit{window(exps[i], w * width, width)};
+            if (digit == 0)
+            {
+                continue;
+            }
+            if (used[digit])
+            {
+                mul_mod(buckets[digit], bases[i], modulus);
+            }
+            else
+            {
+                mpz_mod(buckets[digit].get_mpz_t(), bases[i], modulus.get_mpz_t());
+                used[digit] = true;
+            }
+        }
+
+        mpz_class running{1U}, sum{1U};
+        for (std::size_t digit = size; digit-- > 1;)
+        {
+            if (used[digit])
+            {
+                mul_mod(running, buckets[digit].get_mpz_t(), modulus);
+            }
+            if (running != 1U)
+            {
+                mul_mod(sum, running.get_mpz_t(), modulus);
+            }
+        }
+        mul_mod(result, sum.get_mpz_t(), modulus);
+    }
+
+    return result;
+}
+
+/*
+ * Computes prod bases[i]^exps[i] mod modulus for non-negative exponents as one
+ * multi-exponentiation, so the squarings are shared by all terms.
+ *
+ * Both methods are costed in modular multiplications and the cheaper one runs:
+ * Straus for short vectors, Pippenger once the vector outgrows the per-base tables.
+ * Long vectors are split into chunks that run on the executor.
+ */
+mpz_class multi_exponentiation(const std::vector<mpz_srcptr> &bases,
+                               const std::vector<mpz_srcptr> &exps,
+                               const mpz_class &modulus)
+{
+    static constexpr std::size_t chunk{1024};
+
+    if (bases.size() != exps.size())
+    {
+        throw std::runtime_error("multi-exponentiation needs one exponent per base");
+    }
+
+    mp_bitcnt_t bits{1};
+    for (mpz_srcptr exp : exps)
+    {
+        if (mpz_sgn(exp) < 0)
+        {
+            throw std::runtime_error("multi-exponentiation needs non-negative exponents");
+        }
+        bits = std::max<mp_bitcnt_t>(bits, mpz_sizeinbase(exp, 2));
+    }
+
+    if (bases.size() > chunk)
+    {
+        std::vector<std::future<mpz_class>> parts{};
+        for (std::size_t first = 0; first < bases.size(); first += chunk)
+        {
+            const std::size_t last{std::min(first + chunk, bases.size())};
+            parts.push_back(async([&, first, last]() {
+                return multi_exponentiation({bases.begin() + first, bases.begin() + last},
+                                            {exps.begin() + first, exps.begin() + last},
+                                            modulus);
+            }));
+        }
+
+        mpz_class result{1U};
+        for (auto &part : parts)
+        {
+            mul_mod(result, await(part).get_mpz_t(), modulus);
+        }
+        return result;
+    }
+
+    const double count{static_cast<double>(bases.size())};
+    double straus_cost{0}, pippenger_cost{0};
+    unsigned straus_width{1}, pippenger_width{1};
+
+    for (unsigned width = 1; width <= 16; ++width)
+    {
+        const double windows{std::ceil(static_cast<double>(bits) / width)},
+            size{static_cast<double>(std::size_t{1} << width)},
+            straus{bits + count * (size - 2) + count * windows},
+            pippenger{bits + windows * (count + 2 * size)};
+
+        if (width == 1 || straus < straus_cost)
+        {
+            straus_cost = straus;
+            straus_width = width;
+        }
+        if (width == 1 || pippenger < pippenger_cost)
+        {
+            pippenger_cost = pippenger;
+            pippenger_width = width;
+        }
+    }
+
+    return straus_cost <= pippenger_cost ? straus(bases, exps, modulus, bits, straus_width)
+                                         : pippenger(bases, exps, modulus, bits, pippenger_width);
+}
+
+/*
+ * Fixed-base comb (Lim-Lee) for exponents of at most `bits` bits.
+ *
+ * The exponent is cut into `teeth` rows of `spacing` bits. Entry j of the table holds
+ * the product of base^(2^(i*spacing)) over the bits i set in j, so one column of the
+ * comb costs a single table lookup and multiplication:
+ *
+ * base^e = prod_{col} (table[e_col])^(2^col) mod modulus
+ */
+Comb::Comb(const mpz_class base, const mpz_class modulus, const mp_bitcnt_t bits, const unsigned teeth)
+    : modulus(modulus),
+      bits(bits),
+      spacing((bits + teeth - 1) / teeth),
+      teeth(teeth),
+      table(std::size_t{1} << teeth)
+{
+    mpz_class row{base % modulus};
+    table[0] = 1U;
+
+    for (unsigned i = 0; i < teeth; ++i)
+    {
+        const std::size_t bit{std::size_t{1} << i};
+        for (std::size_t j = bit; j < 2 * bit; ++j)
+        {
+            table[j] = (table[j ^ bit] * row) % modulus;
+        }
+        for (mp_bitcnt_t s = 0; s < spacing; ++s)
+        {
+            row = (row * row) % modulus;
+        }
+    }
+}
+
+/*
+ * Exponentiation using the comb table: spacing squarings and at most spacing multiplications.
+ * Exponents wider than the table fall back to mpz_powm.
+ */
+mpz_class Comb::pow(const mpz_class &exp) const
+{
+    mpz_class result{1U};
+
+    if (mpz_sizeinbase(exp.get_mpz_t(), 2) > bits || exp < 0)
+    {
+        mpz_powm(result.get_mpz_t(), table[1].get_mpz_t(), exp.get_mpz_t(), modulus.get_mpz_t());
+        return result;
+    }
+
+    for (mp_bitcnt_t col = spacing; col-- > 0;)
+    {
+        if (result != 1U)
+        {
+            result = (result * result) % modulus;
+        }
+
+        std::size_t index{0};
+        for (unsigned i = 0; i < teeth; ++i)
+        {
+            index |= static_cast<std::size_t>(mpz_tstbit(exp.get_mpz_t(), col + i * spacing)) << i;
+        }
+
+        if (index != 0)
+        {
+            result = (result * table[index]) % modulus;
+        }
+    }
+
+    return result;
+}
+
+std::vector<mpz_class> Comb::fields() const
+{
+    std::vector<mpz_class> result{modulus, mpz_class{static_cast<unsigned long>(bits)}, mpz_class{teeth}};
+    result.insert(result.end(), table.begin() + 1, table.end());
+    return result;
+}
+
+Comb Comb::from_fields(const std::vector<mpz_class> &fields)
+{
+    if (fields.size() < 3 || fields[2] == 0U || fields[2] > 16U || !fields[1].fits_ulong_p() ||
+        fields.size() != 2 + (std::size_t{1} << fields[2].get_ui()))
+    {
+        throw std::runtime_error("malformed comb table");
+    }
+
+    Comb comb{};
+    comb.modulus = fields[0];
+    comb.bits = fields[1].get_ui();
+    comb.teeth = static_cast<unsigned>(fields[2].get_ui());
+    comb.spacing = (comb.bits + comb.teeth - 1) / comb.teeth;
+    comb.table.assign(fields.begin() + 2, fields.end());
+    comb.table[0] = 1U;
+    return comb;
+}
+
+std::istream &operator>>(std::istream &is, Comb &comb)
+{
+    is >> comb.modulus >> comb.bits >> comb.teeth;
+    if (!is || comb.teeth == 0 || comb.teeth > 16)
+    {
+        is.setstate(std::ios::failbit);
+        return is;
+    }
+
+    comb.spacing = (comb.bits + comb.teeth - 1) / comb.teeth;
+    comb.table.assign(std::size_t{1} << comb.teeth, 1U);
+    for (std::size_t j = 1; j < comb.table.size(); ++j)
+    {
+        is >> comb.table[j];
+    }
+    return is;
+}
+
+std::ostream &operator<<(std::ostream &os, const Comb &comb)
+{
+    os << comb.modulus << "\n"
+       << comb.bits << "\n"
+       << comb.teeth;
+    for (std::size_t j = 1; j < comb.table.size(); ++j)
+    {
+        os << "\n"
+           << comb.table[j];
+    }
+    return os;
+}
+
+static inline std::uint32_t rotate(const std::uint32_t x, const unsigned n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+static inline void quarter_round(std::array<std::uint32_t, 16> &x, const int a, const int b, const int c, const int d)
+{
+    x[a] += x[b], x[d] = rotate(x[d] ^ x[a], 16);
+    x[c] += x[d], x[b] = rotate(x[b] ^ x[c], 12);
+    x[a] += x[b], x[d] = rotate(x[d] ^ x[a], 8);
+    x[c] += x[d], x[b] = rotate(x[b] ^ x[c], 7);
+}
+
+static inline std::uint32_t load32(const std::uint8_t *in)
+{
+    return std::uint32_t{in[0]} | std::uint32_t{in[1]} << 8 | std::uint32_t{in[2]} << 16 | std::uint32_t{in[3]} << 24;
+}
+
+/*
+ * ChaCha20 keystream as specified in RFC 8439: 256-bit key, 96-bit nonce and a
+ * 32-bit block counter. Once the counter wraps the first nonce word is advanced,
+ * so a single key yields an effectively unbounded stream.
+ */
+ChaCha20::ChaCha20(const std::array<std::uint8_t, 32> &key, const std::array<std::uint8_t, 12> &nonce, std::uint32_t counter)
+    : used(64)
+{
+    state[0] = 0x61707865U;
+    state[1] = 0x3320646eU;
+    state[2] = 0x79622d32U;
+    state[3] = 0x6b206574U;
+    for (int i = 0; i < 8; ++i)
+    {
+        state[4 + i] = load32(&key[4 * i]);
+    }
+    state[12] = counter;
+    for (int i = 0; i < 3; ++i)
+    {
+        state[13 + i] = load32(&nonce[4 * i]);
+    }
+}
+
+void ChaCha20::next_block()
+{
+    std::array<std::uint32_t, 16> x{state};
+
+    for (int round = 0; round < 10; ++round)
+    {
+        quarter_round(x, 0, 4, 8, 12);
+        quarter_round(x, 1, 5, 9, 13);
+        quarter_round(x, 2, 6, 10, 14);
+        quarter_round(x, 3, 7, 11, 15);
+        quarter_round(x, 0, 5, 10, 15);
+        quarter_round(x, 1, 6, 11, 12);
+        quarter_round(x, 2, 7, 8, 13);
+        quarter_round(x, 3, 4, 9, 14);
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        const std::uint32_t word{x[i] + state[i]};
+        block[4 * i] = static_cast<std::uint8_t>(word);
+        block[4 * i + 1] = static_cast<std::uint8_t>(word >> 8);
+        block[4 * i + 2] = static_cast<std::uint8_t>(word >> 16);
+        block[4 * i + 3] = static_cast<std::uint8_t>(word >> 24);
+    }
+
+    if (++state[12] == 0)
+    {
+        ++state[13];
+    }
+    used = 0;
+}
+
+void ChaCha20::fill(std::uint8_t *out, std::size_t size)
+{
+    while (size > 0)
+    {
+        if (used == block.size())
+        {
+            next_block();
+        }
+        const std::size_t count{std::min(size, block.size() - used)};
+        std::copy_n(&block[used], count, out);
+        used += count;
+        out += count;
+        size -= count;
+    }
+}
 
-    const mpz_class pq{p * q}, rp{f_rp.get()}, rq{f_rq.get()};
+/*
+ * Every thread owns its own generator (see Random::get), keyed from the
+ * operating system's entropy source.
+ */
+static std::array<std::uint8_t, 32> entropy()
+{
+    std::array<std::uint8_t, 32> key{};
+#if defined(__linux__)
+    std::size_t filled{0};
+    while (filled < key.size())
+    {
+        const ssize_t count{getrandom(&key[filled], key.size() - filled, 0)};
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::runtime_error("getrandom failed to seed the random generator");
+        }
+        filled += static_cast<std::size_t>(count);
+    }
+#else
+    std::random_device noise;
+    for (std::size_t i = 0; i < key.size(); i += 4)
+    {
+        const std::uint32_t word{noise()};
+        std::copy_n(reinterpret_cast<const std::uint8_t *>(&word), 4, &key[i]);
+    }
+#endif
+    return key;
+}
 
-    mpz_class result{(rq - rp + q) * pinvq};
-    result = rp + (result % q) * p;
-    result %= pq;
+Random::Random() : gen(entropy(), {})
+{
+}
 
+/*
+ * Generate random number of at most len bits.
+ */
+mpz_class Random::bits(const mp_bitcnt_t len)
+{
+    mpz_class result{};
+    std::vector<std::uint8_t> bytes((len + 7) / 8);
+    gen.fill(bytes.data(), bytes.size());
+    mpz_import(result.get_mpz_t(), bytes.size(), 1, 1, 0, 0, bytes.data());
+    mpz_fdiv_r_2exp(result.get_mpz_t(), result.get_mpz_t(), len);
     return result;
 }
 
+// odd candidates covered by one sieve pass, and the bound of the sieving primes
+static constexpr std::size_t sieve_window{4096};
+static constexpr unsigned sieve_bound{1U << 16};
+
+/*
+ * Odd primes below sieve_bound, computed once.
+ */
+static const std::vector<unsigned> &small_primes()
+{
+    static const std::vector<unsigned> primes = []() {
+        std::vector<bool> composite(sieve_bound);
+        std::vector<unsigned> result{};
+        for (std::size_t i = 3; i < sieve_bound; i += 2)
+        {
+            if (composite[i])
+            {
+                continue;
+            }
+            result.push_back(static_cast<unsigned>(i));
+            for (std::size_t j = i * i; j < sieve_bound; j += 2 * i)
+            {
+                composite[j] = true;
+            }
+        }
+        return result;
+    }();
+    return primes;
+}
+
+/*
+ * Probable prime of exactly len bits, searched in windows of consecutive odd
+ * candidates above a random start. Each window is sieved by the small primes,
+ * so only candidates without small factors reach the BPSW test of
+ * mpz_probab_prime_p (GMP >= 6.2), followed by one Miller-Rabin round.
+ * The search gives up and returns false once stop is set by another stream.
+ */
+static bool sieve_search(Random &random, mpz_class &result, const mp_bitcnt_t len, const std::atomic<bool> *stop)
+{
+    std::vector<bool> composite(sieve_window);
+    mpz_class base{}, candidate{};
+
+    for (;;)
+    {
+        if (stop && stop->load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        if (base == 0U || mpz_sizeinbase(mpz_class(base + 2 * sieve_window).get_mpz_t(), 2) > len)
+        {
+            base = random.bits(len);
+            mpz_setbit(base.get_mpz_t(), len - 1);
+            mpz_setbit(base.get_mpz_t(), 0);
+        }
+
+        // candidate i is base + 2i, a multiple of p when i = -base/2 mod p
+        std::fill(composite.begin(), composite.end(), false);
+        for (const unsigned p : small_primes())
+        {
+            const unsigned long r{mpz_fdiv_ui(base.get_mpz_t(), p)};
+            for (std::size_t i = ((p - r) % p) * ((p + 1) / 2) % p; i < sieve_window; i += p)
+            {
+                composite[i] = true;
+            }
+        }
+
+        for (std::size_t i = 0; i < sieve_window; ++i)
+        {
+            if (composite[i])
+            {
+                continue;
+            }
+            if (stop && stop->load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+
+            candidate = base + 2 * i;
+            if (mpz_probab_prime_p(candidate.get_mpz_t(), 25))
+            {
+                result = candidate;
+                return true;
+            }
+        }
+
+        base += 2 * sieve_window;
+    }
+}
+
 /*
  * Generate probable prime of given bit width.
+ * Widths too small for the sieve step through mpz_nextprime instead.
  */
 mpz_class Random::prime(const mp_bitcnt_t m)
 {
-    mpz_class random{gen.get_z_bits(m)}, prime{};
-    // ensures that the prime generated has the right number of bits
-    mpz_setbit(random.get_mpz_t(), m - 1);
-    mpz_nextprime(prime.get_mpz_t(), random.get_mpz_t());
-    while (!mpz_probab_prime_p(prime.get_mpz_t(), 15))
+    const OperationTimer timer{Operation::prime};
+    mpz_class prime{};
+
+    if (m <= 17)
     {
-        mpz_nextprime(prime.get_mpz_t(), prime.get_mpz_t());
+        do
+        {
+            mpz_class random{bits(m)};
+            mpz_setbit(random.get_mpz_t(), m - 1);
+            mpz_nextprime(prime.get_mpz_t(), random.get_mpz_t());
+        } while (mpz_sizeinbase(prime.get_mpz_t(), 2) != m);
+        return prime;
     }
+
+    sieve_search(*this, prime, m, nullptr);
     return prime;
 }
 
 /*
- * Generate random number from 0 to n exclusive.
+ * Same as above, with the search run as several speculative streams on the
+ * executor, each from its own random start and generator. The calling thread
+ * runs one stream itself, and the first prime found ends all streams.
+ */
+mpz_class Random::prime(const mp_bitcnt_t m, const std::size_t streams)
+{
+    if (streams <= 1 || m <= 17)
+    {
+        return prime(m);
+    }
+
+    const OperationTimer timer{Operation::prime};
+    std::atomic<bool> found{false};
+    std::mutex lock{};
+    mpz_class result{};
+
+    const auto search = [&](Random &random) {
+        mpz_class candidate{};
+        if (sieve_search(random, candidate, m, &found) && !found.exchange(true))
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            result = candidate;
+        }
+    };
+
+    std::vector<std::future<void>> others{};
+    for (std::size_t i = 1; i < streams; ++i)
+    {
+        others.push_back(tools::async([&search]() { search(Random::get()); }));
+    }
+    search(*this);
+    for (auto &other : others)
+    {
+        tools::await(other);
+    }
+
+    return result;
+}
+
+/*
+ * Generate random number from 0 to n exclusive by rejection sampling on bits of n.
  */
 mpz_class Random::random_n(const mpz_class n)
 {
-    return gen.get_z_range(n);
+    if (n <= 0)
+    {
+        throw std::runtime_error("random numbers below n need a positive n");
+    }
+    const mp_bitcnt_t len{mpz_sizeinbase(n.get_mpz_t(), 2)};
+    mpz_class result{bits(len)};
+    while (result >= n)
+    {
+        result = bits(len);
+    }
+    return result;
+}
+
+/*
+ * Generate count random numbers from 0 to n exclusive.
+ * The key stream for all of them is drawn in one fill, only rejected values draw again.
+ */
+std::vector<mpz_class> Random::random_n(const mpz_class n, const std::size_t count)
+{
+    if (n <= 0)
+    {
+        throw std::runtime_error("random numbers below n need a positive n");
+    }
+    const mp_bitcnt_t len{mpz_sizeinbase(n.get_mpz_t(), 2)};
+    const std::size_t width{(len + 7) / 8};
+    std::vector<std::uint8_t> bytes(width * count);
+    std::vector<mpz_class> result(count);
+
+    gen.fill(bytes.data(), bytes.size());
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        mpz_import(result[i].get_mpz_t(), width, 1, 1, 0, 0, &bytes[i * width]);
+        mpz_fdiv_r_2exp(result[i].get_mpz_t(), result[i].get_mpz_t(), len);
+        while (result[i] >= n)
+        {
+            result[i] = bits(len);
+        }
+    }
+    return result;
+}
+
+/*
+ * Generate random number from 1 to n exclusive which is relatively prime to n.
+ */
+mpz_class Random::relatively_prime(const mpz_class n)
+{
+    mpz_class result{0U};
+    while (result == 0U || gcd(result, n) != 1)
+    {
+        result = random_n(n);
+    }
+    return result;
+}
+
+/*
+ * Generate count random numbers relatively prime to n with one bulk draw.
+ */
+std::vector<mpz_class> Random::relatively_prime(const mpz_class n, const std::size_t count)
+{
+    std::vector<mpz_class> result{random_n(n, count)};
+    for (auto &value : result)
+    {
+        while (value == 0U || gcd(value, n) != 1)
+        {
+            value = random_n(n);
+        }
+    }
+    return result;
 }
 
 } // paillier::tools
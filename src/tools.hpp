@@ -1,16 +1,25 @@
 #ifndef PAILLIER_TOOLS_HPP
 #define PAILLIER_TOOLS_HPP
 
+#include <array>
+#include <cstdint>
 #include <gmpxx.h>
+#include <iostream>
 #include <memory>
-#include <random>
 #include <string>
+#include <vector>
 
 namespace paillier::tools
 {
 
 inline void debug_msg(std::string_view msg);
 
+mpz_class crt_combine(const mpz_class rp,
+                      const mpz_class rq,
+                      const mpz_class pinvq,
+                      const mpz_class p,
+                      const mpz_class q);
+
 mpz_class crt_exponentiation(const mpz_class base,
                              const mpz_class exp_p,
                              const mpz_class exp_q,
@@ -18,16 +27,52 @@ mpz_class crt_exponentiation(const mpz_class base,
                              const mpz_class p,
                              const mpz_class q);
 
+mpz_class multi_exponentiation(const std::vector<mpz_srcptr> &bases,
+                               const std::vector<mpz_srcptr> &exps,
+                               const mpz_class &modulus);
+
+class Comb
+{
+    mpz_class modulus;
+    mp_bitcnt_t bits, spacing;
+    unsigned teeth;
+    std::vector<mpz_class> table;
+
+  public:
+    Comb() = default;
+    Comb(const mpz_class base, const mpz_class modulus, const mp_bitcnt_t bits, const unsigned teeth = 6);
+
+    mp_bitcnt_t width() const { return bits; }
+    mpz_class pow(const mpz_class &exp) const;
+
+    // flat form for the binary key format: modulus, bits, teeth, then table[1] onwards
+    std::vector<mpz_class> fields() const;
+    static Comb from_fields(const std::vector<mpz_class> &fields);
+
+    friend std::istream &operator>>(std::istream &is, Comb &comb);
+    friend std::ostream &operator<<(std::ostream &os, const Comb &comb);
+};
+
+class ChaCha20
+{
+    std::array<std::uint32_t, 16> state;
+    std::array<std::uint8_t, 64> block;
+    std::size_t used;
+
+    void next_block();
+
+  public:
+    ChaCha20(const std::array<std::uint8_t, 32> &key, const std::array<std::uint8_t, 12> &nonce, std::uint32_t counter = 0);
+
+    void fill(std::uint8_t *out, std::size_t size);
+};
+
 class Random
 {
-    std::random_device noise;
-    gmp_randclass gen;
+    ChaCha20 gen;
 
   protected:
-    Random() : gen(gmp_randinit_default)
-    {
-        gen.seed(noise());
-    }
+    Random();
 
   public:
     Random(Random const &) = delete;
@@ -35,12 +80,17 @@ class Random
 
     static Random &get()
     {
-        static Random instance;
+        static thread_local Random instance;
         return instance;
     }
 
+    mpz_class bits(const mp_bitcnt_t len);
     mpz_class prime(const mp_bitcnt_t len);
+    mpz_class prime(const mp_bitcnt_t len, const std::size_t streams);
     mpz_class random_n(const mpz_class n);
+    std::vector<mpz_class> random_n(const mpz_class n, const std::size_t count);
+    mpz_class relatively_prime(const mpz_class n);
+    std::vector<mpz_class> relatively_prime(const mpz_class n, const std::size_t count);
 };
 
 } // paillier::tools
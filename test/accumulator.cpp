@@ -0,0 +1,37 @@
+#include <paillier.hpp>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    const auto [priv, pub] = key::gen(1024);
+    const PublicContext ctx{pub};
+
+    Accumulator acc{ctx};
+    if (acc.get().decrypt(priv).text != 0)
+    {
+        return 1;
+    }
+
+    std::vector<PlainText> plains{};
+    for (unsigned m = 0; m < 500; ++m)
+    {
+        plains.emplace_back(m);
+    }
+    for (const CipherText &c : encrypt_batch(plains, ctx))
+    {
+        acc.add(c);
+    }
+
+    // sum of 0..499 = 124750
+    const CipherText total{acc.get()};
+    if (total.text >= ctx.n2 || total.decrypt(priv).text != 124750)
+    {
+        return 1;
+    }
+
+    acc.mult(3);
+    acc.add(PlainText(50).encrypt(ctx));
+
+    return acc.get().decrypt(priv).text != 3 * 124750 + 50;
+}
@@ -0,0 +1,38 @@
+#include <paillier.hpp>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    const auto [priv, pub] = key::gen(1024);
+    const PublicContext ctx{pub};
+
+    std::vector<PlainText> plains{};
+    for (unsigned m = 0; m < 24; ++m)
+    {
+        plains.emplace_back(m);
+    }
+
+    CipherTextBatch a{encrypt_batch(plains, ctx), ctx}, b{ctx};
+    for (unsigned m = 0; m < 24; ++m)
+    {
+        b.push_back(PlainText(100).encrypt(ctx), ctx);
+    }
+
+    a.add(b, ctx);
+    a.mult(3, ctx);
+
+    const std::vector<PlainText> decrypted{a.decrypt(priv)};
+    for (unsigned m = 0; m < 24; ++m)
+    {
+        if (decrypted[m].text != 3 * (m + 100))
+        {
+            return 1;
+        }
+    }
+
+    // views convert back to the regular ciphertext type
+    const CipherText c{a[5]};
+
+    return c.decrypt(priv).text != 315;
+}
@@ -0,0 +1,75 @@
+#include <atomic>
+#include <paillier.hpp>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    const auto [priv, pub] = key::gen(1024);
+    const PublicContext ctx{pub}, short_ctx{key::with_short_exponent(pub)};
+
+    std::vector<PlainText> plains{};
+    for (unsigned m = 0; m < 32; ++m)
+    {
+        plains.emplace_back(m);
+    }
+
+    key::Private legacy{priv};
+    legacy.hp = legacy.hq = 0U;
+
+    const std::vector<CipherText> ciphers{encrypt_batch(plains, ctx)}, short_ciphers{encrypt_batch(plains, short_ctx)};
+    const std::vector<PlainText> decrypted{decrypt_batch(ciphers, priv)},
+        legacy_decrypted{decrypt_batch(ciphers, legacy)},
+        short_decrypted{decrypt_batch(short_ciphers, priv)};
+
+    for (unsigned m = 0; m < 32; ++m)
+    {
+        if (decrypted[m].text != m || legacy_decrypted[m].text != m || short_decrypted[m].text != m)
+        {
+            return 1;
+        }
+    }
+
+    // a failing chunk surfaces once every other chunk has run
+    std::atomic<std::size_t> done{0};
+    try
+    {
+        paillier::tools::parallel_for(1000, [&done](std::size_t first, std::size_t last) {
+            if (first == 0)
+            {
+                throw std::runtime_error("failing chunk");
+            }
+            done += last - first;
+        });
+        return 1;
+    }
+    catch (const std::runtime_error &)
+    {
+        const std::size_t tasks{4 * paillier::tools::Executor::get().size()}, first{1000 / tasks + (1000 % tasks != 0)};
+        if (done != 1000 - first)
+        {
+            return 1;
+        }
+    }
+
+    // a failing ciphertext surfaces once every other half has finished with the batch
+    try
+    {
+        decrypt_batch(
+            ciphers.size(),
+            [&ciphers](std::size_t i) {
+                if (i == 3)
+                {
+                    throw std::runtime_error("unreadable ciphertext");
+                }
+                return ciphers[i].text;
+            },
+            priv);
+        return 1;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+
+    return 0;
+}
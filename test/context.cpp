@@ -0,0 +1,19 @@
+#include <paillier.hpp>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    const auto [priv, pub] = key::gen(1024);
+    const PublicContext ctx{pub};
+
+    // ninv is -(n^2)^-1 modulo the limb base
+    if (static_cast<mp_limb_t>(mpz_getlimbn(ctx.n2.get_mpz_t(), 0) * ctx.ninv) != ~mp_limb_t{0})
+    {
+        return 1;
+    }
+
+    const CipherText a{PlainText(3).encrypt(ctx)}, b{PlainText(4).encrypt(pub)};
+
+    return a.add(b, ctx).mult(5, ctx).decrypt(priv).text != 35;
+}
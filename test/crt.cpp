@@ -0,0 +1,34 @@
+#include <paillier.hpp>
+#include <sstream>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    const auto [priv, pub] = key::gen(1024);
+
+    const CipherText a{PlainText(3).encrypt(priv)}, b{PlainText(4).encrypt(pub)}, c{a.add(b, pub)};
+
+    key::Private loaded{}, legacy{priv};
+    {
+        std::stringstream file{};
+        file << priv;
+        file >> loaded;
+    }
+    legacy.hp = 0U;
+
+    if (loaded.hq != priv.hq || legacy.hp != 0U)
+    {
+        return 1;
+    }
+
+    if (c.decrypt(loaded).text != 7 || c.decrypt(legacy).text != 7)
+    {
+        return 1;
+    }
+
+    // a custom g = 78 exercises hp and hq for g != n + 1
+    const auto [priv_g, pub_g] = key::seed(8, 7, 11, 78);
+
+    return PlainText(5).encrypt(pub_g).decrypt(priv_g).text != 5;
+}
@@ -0,0 +1,59 @@
+#include <paillier.hpp>
+#include <sstream>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    for (const unsigned s : {2U, 3U})
+    {
+        for (const bool short_exponent : {false, true})
+        {
+            const auto [priv, pub] = key::gen(768, short_exponent, s);
+            const PublicContext ctx{pub};
+            const mpz_class ns{pub.modulus() / pub.n};
+
+            // plaintexts range over n^s, well beyond n
+            const mpz_class a{ns - 5U}, b{ns / 7U + 12345U};
+            const CipherText ca{PlainText(a).encrypt(ctx)}, cb{PlainText(b).encrypt(pub)};
+
+            if (mpz_sizeinbase(ca.text.get_mpz_t(), 2) <= mpz_sizeinbase(ns.get_mpz_t(), 2))
+            {
+                return 1;
+            }
+            if (ca.decrypt(priv).text != a || cb.decrypt(priv).text != b)
+            {
+                return 1;
+            }
+            if (ca.add(cb, ctx).decrypt(priv).text != (a + b) % ns)
+            {
+                return 1;
+            }
+            if (cb.mult(7, ctx).decrypt(priv).text != (7 * b) % ns)
+            {
+                return 1;
+            }
+
+            // n is an ordinary plaintext once s > 1, on every encryption path
+            if (PlainText(pub.n).encrypt(pub).decrypt(priv).text != pub.n ||
+                PlainText(pub.n).encrypt(ctx).decrypt(priv).text != pub.n ||
+                encrypt_batch({PlainText(pub.n)}, ctx).front().decrypt(priv).text != pub.n)
+            {
+                return 1;
+            }
+
+            std::stringstream keys{};
+            keys << pub << "\n"
+                 << priv;
+            key::Public pub_in{};
+            key::Private priv_in{};
+            keys >> pub_in >> priv_in;
+            if (pub_in.s != s || priv_in.s != s || PlainText(b).encrypt(pub_in).decrypt(priv_in).text != b)
+            {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
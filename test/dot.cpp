@@ -0,0 +1,50 @@
+#include <paillier.hpp>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    const auto [priv, pub] = key::gen(1024);
+    const PublicContext ctx{pub};
+
+    // short vectors take Straus' method, long ones Pippenger's buckets split over the executor
+    for (const unsigned size : {7U, 3000U})
+    {
+        std::vector<PlainText> plains{};
+        std::vector<mpz_class> scalars{};
+        mpz_class expected{0U};
+
+        for (unsigned i = 0; i < size; ++i)
+        {
+            plains.emplace_back(i % 17);
+            scalars.emplace_back((i * 2654435761U) % 65536U);
+            expected += (i % 17) * scalars.back();
+        }
+
+        const CipherText c{dot(encrypt_batch(plains, ctx), scalars, ctx)};
+
+        if (c.decrypt(priv).text != expected)
+        {
+            return 1;
+        }
+    }
+
+    // negative weights are taken mod n^s, as by mult_plain
+    const std::vector<CipherText> ciphers{encrypt_batch({PlainText{5U}, PlainText{7U}}, ctx)};
+    if (dot(ciphers, {mpz_class{3}, mpz_class{-2}}, ctx).decrypt(priv).text != 1U ||
+        dot(ciphers, {mpz_class{-3}, mpz_class{2}}, ctx).decrypt(priv).text != ctx.ns - 1U)
+    {
+        return 1;
+    }
+
+    try
+    {
+        dot(ciphers, {mpz_class{1}}, ctx);
+        return 1;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <cmath>
+#include <paillier.hpp>
+
+using namespace paillier::impl;
+
+static bool approx(double a, double b)
+{
+    return std::fabs(a - b) <= 1e-6 * std::max(1.0, std::fabs(b));
+}
+
+int main()
+{
+    const auto [priv, pub] = key::gen(1024);
+    const PublicContext ctx{pub};
+    const FixedPointEncoder binary{pub}, decimal{pub, 10, -4};
+
+    // exact binary fractions and decimals at their own precision round trip
+    if (binary.decode(binary.encode(-3.25), -32) != -3.25 || decimal.decode(decimal.encode(1.2345), -4) != 1.2345 ||
+        binary.decode(binary.encode(5e9, 3), 3) != 5e9)
+    {
+        return 1;
+    }
+
+    // mixed exponents: -32 from the batch, -40 and 0 given explicitly
+    std::vector<EncodedNumber> numbers{binary.encrypt(std::vector<double>{1.5, -2.75, 0.125}, ctx)};
+    numbers.push_back(binary.encrypt(-0.0625, -40, ctx));
+    numbers.push_back(binary.encrypt(100.0, 0, ctx));
+    const std::vector<double> values{1.5, -2.75, 0.125, -0.0625, 100.0};
+
+    const EncodedNumber total{binary.sum(numbers, ctx)};
+    if (total.exponent != -40 || !approx(binary.decrypt(total, priv), 98.8125))
+    {
+        return 1;
+    }
+
+    const EncodedNumber pair{binary.add(numbers[1], numbers[3], ctx)};
+    if (pair.exponent != -40 || binary.decrypt(pair, priv) != -2.8125 ||
+        binary.decrypt(binary.add(numbers[0], -4.5, ctx), priv) != -3.0 ||
+        !approx(binary.decrypt(binary.mult(numbers[1], -0.5, ctx), priv), 1.375))
+    {
+        return 1;
+    }
+
+    // a known fraction added to a number at a coarse exponent is not rounded away
+    const EncodedNumber shifted{binary.add(numbers[4], 0.4, ctx)};
+    if (shifted.exponent != -32 || !approx(binary.decrypt(shifted, priv), 100.4) ||
+        binary.add(numbers[3], 1.0, ctx).exponent != -40)
+    {
+        return 1;
+    }
+
+    // alignment folded into the multi-exponentiation of the dot product
+    const std::vector<double> weights{0.5, -1.25, 3.0, 8.0, -0.01};
+    double expected{0};
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        expected += values[i] * weights[i];
+    }
+    const EncodedNumber product{binary.dot(numbers, weights, ctx)};
+    if (product.exponent != -72 || !approx(binary.decrypt(product, priv), expected))
+    {
+        return 1;
+    }
+
+    const std::vector<double> decrypted{binary.decrypt(numbers, priv)};
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        if (decrypted[i] != values[i])
+        {
+            return 1;
+        }
+    }
+
+    try
+    {
+        binary.encode(1e300, -32);
+        return 1;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+
+    return 0;
+}
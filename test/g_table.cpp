@@ -0,0 +1,57 @@
+#include <fstream>
+#include <paillier.hpp>
+#include <sstream>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    std::string seed = "tmp/seed_g",
+                priv_key = "tmp/priv_g",
+                pub_key = "tmp/pub_g";
+
+    {
+        mpz_class p{paillier::tools::Random::get().prime(512)}, q{paillier::tools::Random::get().prime(512)};
+        std::fstream seed_out(seed, seed_out.out);
+        seed_out << 1024 << "\n"
+                 << p << "\n"
+                 << q << "\n"
+                 << 2 << std::endl;
+    }
+
+    paillier::io::keyseed(pub_key, priv_key, seed);
+
+    key::Public pub{};
+    key::Private priv{};
+
+    {
+        std::fstream pub_in(pub_key, pub_in.in);
+        std::fstream priv_in(priv_key, priv_in.in);
+        pub_in >> pub;
+        priv_in >> priv;
+    }
+
+    if (!pub.g_table)
+    {
+        return 1;
+    }
+
+    // the binary format persists the table as well
+    std::stringstream binary{};
+    paillier::io::write_key(binary, pub);
+    key::Public binary_pub{};
+    paillier::io::read_key(binary, binary_pub);
+    if (!binary_pub.g_table || binary_pub.g_table->fields() != pub.g_table->fields() ||
+        PlainText(6).encrypt(binary_pub).decrypt(priv).text != 6)
+    {
+        return 1;
+    }
+
+    key::Public bare{pub};
+    bare.g_table.reset();
+
+    const PublicContext ctx{pub}, lazy_ctx{bare};
+    const CipherText a{PlainText(3).encrypt(ctx)}, b{PlainText(4).encrypt(lazy_ctx)}, c{PlainText(5).encrypt(pub)};
+
+    return a.add(b, ctx).add(c, ctx).decrypt(priv).text != 12;
+}
@@ -0,0 +1,75 @@
+#include <numeric>
+#include <paillier.hpp>
+#include <sstream>
+
+int main()
+{
+    using namespace paillier;
+    using tools::Metrics;
+    using tools::Operation;
+
+    // buckets are contiguous and every value lies below the limit of its bucket
+    for (std::uint64_t value : {0ULL, 1ULL, 7ULL, 8ULL, 15ULL, 16ULL, 1000ULL, 123456789ULL, ~0ULL})
+    {
+        const std::size_t index{Metrics::bucket(value)};
+        if (index >= Metrics::buckets || (value != ~0ULL && value >= Metrics::bucket_limit(index)) ||
+            (index > 0 && value < Metrics::bucket_limit(index - 1)))
+        {
+            return 1;
+        }
+    }
+
+    Metrics &metrics{Metrics::get()};
+    const auto [priv, pub] = impl::key::gen(512);
+    const impl::PublicContext ctx{pub};
+    metrics.reset();
+
+    std::vector<impl::CipherText> ciphers{};
+    for (unsigned i = 0; i < 5; ++i)
+    {
+        ciphers.push_back(impl::PlainText{i}.encrypt(ctx));
+    }
+    const auto plains = impl::decrypt_batch(ciphers, priv);
+    ciphers[0].add(ciphers[1], ctx).mult(3, ctx).decrypt(priv);
+
+    std::stringstream buffer{};
+    io::write_ciphers(buffer, ciphers, pub);
+    io::read_ciphers(buffer, pub);
+
+    const auto encrypt = metrics.stats(Operation::encrypt), decrypt = metrics.stats(Operation::decrypt);
+    if (encrypt.calls != 5 || decrypt.calls != 6 ||
+        metrics.stats(Operation::add).calls != 1 || metrics.stats(Operation::mult).calls != 1 ||
+        std::accumulate(encrypt.histogram.begin(), encrypt.histogram.end(), std::uint64_t{0}) != 5 ||
+        encrypt.cycles == 0 || encrypt.percentile(50) == 0 || encrypt.percentile(50) > encrypt.percentile(100))
+    {
+        return 1;
+    }
+
+    // binary records are exactly sized, so both directions count the whole buffer
+    const std::uint64_t bytes{buffer.str().size()};
+    if (metrics.stats(Operation::io_write).bytes != bytes || metrics.stats(Operation::io_read).bytes != bytes)
+    {
+        return 1;
+    }
+
+    std::ostringstream json{}, prometheus{};
+    metrics.write_json(json);
+    metrics.write_prometheus(prometheus);
+    if (json.str().find("\"name\": \"crt_exponentiation\"") == std::string::npos ||
+        prometheus.str().find("paillier_operation_calls_total{operation=\"encrypt\"} 5") == std::string::npos ||
+        prometheus.str().find("paillier_operation_cycles_count{operation=\"decrypt\"} 6") == std::string::npos)
+    {
+        return 1;
+    }
+
+    metrics.enable(false);
+    impl::PlainText{1U}.encrypt(ctx);
+    metrics.enable(true);
+    if (metrics.stats(Operation::encrypt).calls != 5)
+    {
+        return 1;
+    }
+
+    metrics.reset();
+    return metrics.stats(Operation::encrypt).calls == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#include <paillier.hpp>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    const auto [priv, pub] = key::gen(1024);
+    const PublicContext ctx{pub};
+    const PackedEncoder encoder{pub, 32, 8};
+
+    if (encoder.slots() != 1023 / 40)
+    {
+        return 1;
+    }
+
+    std::vector<mpz_class> a{}, b{};
+    for (unsigned i = 0; i < 60; ++i)
+    {
+        a.emplace_back(4000000000U - i);
+        b.emplace_back(i * i);
+    }
+
+    const std::vector<PackedCipherText> ca{encoder.encrypt(a, ctx)}, cb{encoder.encrypt(b, ctx)};
+    if (ca.size() != 3 || ca.back().count != 60 - 2 * encoder.slots())
+    {
+        return 1;
+    }
+
+    std::vector<PackedCipherText> result{};
+    for (std::size_t group = 0; group < ca.size(); ++group)
+    {
+        result.push_back(ca[group].add(cb[group], ctx).mult(3, ctx));
+    }
+
+    const std::vector<mpz_class> values{encoder.decrypt(result, priv)};
+    for (unsigned i = 0; i < 60; ++i)
+    {
+        if (values[i] != 3 * (a[i] + b[i]))
+        {
+            return 1;
+        }
+    }
+
+    // 32-bit values plus 8 headroom bits leave no room for a 16-bit scalar
+    try
+    {
+        result.front().mult(1U << 15, ctx);
+        return 1;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <paillier.hpp>
+
+using namespace paillier::impl;
+
+/*
+ * Plaintext operations on a key with g = 1+n, a custom g and a key of degree 2.
+ */
+static bool check(const key::Private &priv, const key::Public &pub)
+{
+    const PublicContext ctx{pub};
+    const mpz_class ns{ctx.ns};
+    const CipherText c{PlainText{1000U}.encrypt(ctx)};
+
+    const CipherText shifted{c.add_plain(PlainText{23U}, ctx).sub_plain(PlainText{3U}, ctx)};
+    if (shifted.decrypt(priv).text != 1020U || c.sub_plain(PlainText{2000U}, ctx).decrypt(priv).text != ns - 1000U ||
+        c.add_plain(PlainText{ns + 5U}, ctx).decrypt(priv).text != 1005U ||
+        c.add_plain(PlainText{-1000}, ctx).decrypt(priv).text != 0U)
+    {
+        return false;
+    }
+
+    if (c.mult_plain(PlainText{5U}, ctx).decrypt(priv).text != 5000U ||
+        c.mult_plain(PlainText{-3}, ctx).decrypt(priv).text != ns - 3000U ||
+        c.mult_plain(PlainText{0U}, ctx).decrypt(priv).text != 0U)
+    {
+        return false;
+    }
+
+    // with g = 1+n equal shifts give equal ciphertexts, rerandomizing changes the ciphertext but not the plaintext
+    const CipherText fresh{shifted.rerandomize(ctx)};
+    return (!ctx.g_n1 || shifted.text == c.add_plain(PlainText{20U}, ctx).text) && fresh.text != shifted.text &&
+           fresh.decrypt(priv).text == 1020U;
+}
+
+int main()
+{
+    const auto [priv, pub] = key::gen(1024);
+    if (!check(priv, pub))
+    {
+        return 1;
+    }
+
+    const auto [priv_g, pub_g] = key::seed(1024, priv.p, priv.q, priv.n + 2U);
+    if (!check(priv_g, key::with_g_table(pub_g)) || !check(priv_g, pub_g))
+    {
+        return 1;
+    }
+
+    const auto [priv_s, pub_s] = key::seed_degree(1024, priv.p, priv.q, 2);
+    if (!check(priv_s, pub_s))
+    {
+        return 1;
+    }
+
+    const auto [priv_h, pub_h] = key::gen(1024, true);
+    return check(priv_h, pub_h) ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include <chrono>
+#include <filesystem>
+#include <paillier.hpp>
+#include <thread>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    const auto [priv, pub] = key::gen(1024);
+    RandomnessPool pool(pub, 8, 2);
+
+    for (unsigned m = 0; m < 16; ++m)
+    {
+        const CipherText c{PlainText(m).encrypt(pub, pool)};
+        if (c.decrypt(priv).text != m)
+        {
+            return 1;
+        }
+    }
+
+    const CipherText a{PlainText(3).encrypt(pub, pool)}, b{PlainText(4).encrypt(pub, pool)};
+    if (a.add(b, pub).decrypt(priv).text != 7)
+    {
+        return 1;
+    }
+
+    // key pairs are generated in the background and survive in the spool
+    const std::string spool = "tmp/key_spool";
+    const std::array<std::uint8_t, 32> spool_key{1, 2, 3};
+    std::filesystem::remove_all(spool);
+    {
+        KeyPool keys({512, 768}, spool, spool_key, 2, 1);
+        while (keys.available(512) < 2 || keys.available(768) < 2)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    KeyPool keys({512}, spool, spool_key, 2, 0);
+    if (keys.available(512) != 2 || keys.available(768) != 0)
+    {
+        return 1;
+    }
+
+    // the third pair of a pool without workers is generated on the spot
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        const auto [kpriv, kpub] = keys.take(512);
+        if (kpub.k != 512 || PlainText(i).encrypt(kpub).decrypt(kpriv).text != i)
+        {
+            return 1;
+        }
+    }
+
+    // a pool for short exponent keys does not serve the full exponent pairs of the spool
+    if (KeyPool({768}, spool, spool_key, 2, 0, true).available(768) != 0)
+    {
+        return 1;
+    }
+
+    // a restarted pool does not serve the pairs already handed out, other keys cannot read the spool
+    const std::array<std::uint8_t, 32> other_key{3, 2, 1};
+    if (KeyPool({512}, spool, spool_key, 2, 0).available(512) != 0 ||
+        KeyPool({512, 768}, spool, other_key, 2, 0).available(768) != 0)
+    {
+        return 1;
+    }
+
+    // two pools sharing the spool both load its pairs, but each pair is served once
+    KeyPool first({768}, spool, spool_key, 2, 0), second({768}, spool, spool_key, 2, 0);
+    if (first.available(768) != 2 || second.available(768) != 2)
+    {
+        return 1;
+    }
+    const mpz_class n1{first.take(768).second.n}, n2{first.take(768).second.n};
+    const mpz_class n3{second.take(768).second.n}, n4{second.take(768).second.n};
+    return n3 == n1 || n3 == n2 || n4 == n1 || n4 == n2 || !std::filesystem::is_empty(spool);
+}
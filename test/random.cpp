@@ -0,0 +1,74 @@
+#include <paillier.hpp>
+#include <thread>
+
+int main()
+{
+    using namespace paillier::tools;
+
+    // RFC 8439 section 2.3.2 block function test vector
+    std::array<std::uint8_t, 32> key{};
+    for (std::uint8_t i = 0; i < key.size(); ++i)
+    {
+        key[i] = i;
+    }
+    const std::array<std::uint8_t, 12> nonce{0, 0, 0, 0x09, 0, 0, 0, 0x4a, 0, 0, 0, 0};
+    const std::array<std::uint8_t, 16> expected{0x10, 0xf1, 0xe7, 0xe4, 0xd1, 0x3b, 0x59, 0x15,
+                                                0x50, 0x0f, 0xdd, 0x1f, 0xa3, 0x20, 0x71, 0xc4};
+    std::array<std::uint8_t, 16> block{};
+
+    ChaCha20(key, nonce, 1).fill(block.data(), block.size());
+    if (block != expected)
+    {
+        return 1;
+    }
+
+    // every thread draws from its own stream
+    const mpz_class n{"340282366920938463463374607431768211297"};
+    std::vector<mpz_class> a{}, b{};
+    std::thread other([&]() { a = Random::get().random_n(n, 64); });
+    b = Random::get().random_n(n, 64);
+    other.join();
+
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        if (a[i] >= n || b[i] >= n || a[i] == b[i])
+        {
+            return 1;
+        }
+    }
+
+    // an empty or negative range has nothing to draw from
+    for (const mpz_class &bound : {mpz_class{0}, mpz_class{-5}})
+    {
+        try
+        {
+            Random::get().random_n(bound);
+            return 1;
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+        try
+        {
+            Random::get().random_n(bound, 4);
+            return 1;
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+    }
+
+    // sieved and speculative prime searches keep the requested width
+    for (const mp_bitcnt_t len : {12U, 64U, 512U})
+    {
+        for (const mpz_class &p : {Random::get().prime(len), Random::get().prime(len, 4)})
+        {
+            if (mpz_sizeinbase(p.get_mpz_t(), 2) != len || !mpz_probab_prime_p(p.get_mpz_t(), 25))
+            {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+#include <fstream>
+#include <paillier.hpp>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    std::string priv_key = "tmp/priv_short1024",
+                pub_key = "tmp/pub_short1024";
+
+    paillier::io::keygen(pub_key, priv_key, 1024, true);
+
+    key::Public pub{};
+    key::Private priv{};
+
+    {
+        std::fstream pub_in(pub_key, pub_in.in);
+        std::fstream priv_in(priv_key, priv_in.in);
+        pub_in >> pub;
+        priv_in >> priv;
+    }
+
+    if (pub.hs == 0U || !pub.hs_table)
+    {
+        return 1;
+    }
+
+    const CipherText a{PlainText(3).encrypt(pub)}, b{PlainText(4).encrypt(pub)};
+
+    return a.add(b, pub).decrypt(priv).text != 7;
+}
@@ -0,0 +1,94 @@
+#include <fstream>
+#include <paillier.hpp>
+
+int main()
+{
+    using namespace paillier::impl;
+    namespace io = paillier::io;
+
+    const auto [priv, pub] = key::gen(1024);
+    const PublicContext ctx{pub};
+    const std::string path = "tmp/store";
+
+    {
+        auto store = io::CipherTextStore::create(path, pub);
+        for (unsigned m = 0; m < 40; ++m)
+        {
+            store.append(PlainText(m).encrypt(ctx));
+        }
+    }
+
+    // files written by write_ciphers open as stores too
+    {
+        std::fstream out("tmp/store_written", std::ios::out | std::ios::binary);
+        io::write_ciphers(out, {PlainText(7).encrypt(ctx)}, pub);
+    }
+    if (CipherText{io::CipherTextStore::open("tmp/store_written", pub)[0]}.decrypt(priv).text != 7)
+    {
+        return 1;
+    }
+
+    auto store = io::CipherTextStore::open(path, pub, true);
+    if (store.size() != 40 || store.width() != ctx.limbs)
+    {
+        return 1;
+    }
+
+    const CipherText c{store[17]};
+    if (c.decrypt(priv).text != 17)
+    {
+        return 1;
+    }
+
+    // sum of the slice [10, 20) = 145
+    const io::CipherTextSlice slice{store.slice(10, 20)};
+    CipherText sum{slice[0]};
+    for (std::size_t i = 1; i < slice.size(); ++i)
+    {
+        sum = sum.add(slice[i], ctx);
+    }
+    if (sum.decrypt(priv).text != 145)
+    {
+        return 1;
+    }
+
+    store.append({PlainText(100).encrypt(ctx), PlainText(101).encrypt(ctx)});
+    if (store.size() != 42 || CipherText(store[41]).decrypt(priv).text != 101)
+    {
+        return 1;
+    }
+
+    // a batch with a record too wide for the store is rejected as a whole
+    try
+    {
+        store.append({PlainText(102).encrypt(ctx), CipherText{ctx.n2 * ctx.n2}});
+        return 1;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+    if (store.size() != 42 || io::CipherTextStore::open(path).size() != 42)
+    {
+        return 1;
+    }
+
+    try
+    {
+        store.at(42);
+        return 1;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+
+    try
+    {
+        io::CipherTextStore::open(path, key::gen(1024).second);
+        return 1;
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <paillier.hpp>
+#include <sstream>
+
+int main()
+{
+    using namespace paillier::impl;
+    namespace io = paillier::io;
+
+    const auto [priv, pub] = key::gen(1024);
+
+    std::stringstream plains{};
+    for (unsigned m = 0; m < 500; ++m)
+    {
+        plains << m << (m % 7 == 0 ? "\n" : " ");
+    }
+
+    for (const io::Format format : {io::Format::text, io::Format::binary})
+    {
+        std::stringstream input{plains.str()}, ciphers{}, output{};
+        io::encrypt_stream(input, ciphers, pub, format, 64);
+
+        if (io::detect(ciphers) != format)
+        {
+            return 1;
+        }
+
+        io::decrypt_stream(ciphers, output, priv, 48);
+
+        unsigned value{}, expected{0};
+        while (output >> value)
+        {
+            if (value != expected++)
+            {
+                return 1;
+            }
+        }
+        if (expected != 500)
+        {
+            return 1;
+        }
+    }
+
+    // a value that does not parse is an error, not the end of the stream, and empty chunks are rejected
+    std::stringstream malformed_plains{"1 2 x 4"}, malformed_ciphers{"12345\nx\n"}, sink{};
+    const auto fails = [](auto &&call) {
+        try
+        {
+            call();
+            return false;
+        }
+        catch (const std::runtime_error &)
+        {
+            return true;
+        }
+    };
+    if (!fails([&]() { io::encrypt_stream(malformed_plains, sink, pub, io::Format::text, 64); }) ||
+        !fails([&]() { io::decrypt_stream(malformed_ciphers, sink, priv, 64); }) ||
+        !fails([&]() { io::encrypt_stream(plains, sink, pub, io::Format::text, 0); }) ||
+        !fails([&]() { io::decrypt_stream(plains, sink, priv, 0); }))
+    {
+        return 1;
+    }
+
+    // binary headers are checked like files: zero, huge and foreign record widths and truncated headers fail
+    const PublicContext ctx{pub};
+    for (const std::uint32_t width : {0U, 0xffffffffU, io::limbs(ctx.n2) + 1})
+    {
+        const auto header = io::Header{io::Header::current, io::Kind::ciphers, io::fingerprint(pub.n), width, 2}.serialize();
+        std::stringstream crafted{std::string(header.begin(), header.end()) + std::string(64, '\0')};
+        if (!fails([&]() { io::decrypt_stream(crafted, sink, priv, 64); }))
+        {
+            return 1;
+        }
+    }
+    std::stringstream binary_input{plains.str()}, binary{};
+    io::encrypt_stream(binary_input, binary, pub, io::Format::binary, 64);
+    std::stringstream truncated{binary.str().substr(0, io::Header::size - 1)};
+    if (!fails([&]() { io::decrypt_stream(truncated, sink, priv, 64); }))
+    {
+        return 1;
+    }
+
+    return 0;
+}
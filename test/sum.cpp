@@ -0,0 +1,28 @@
+#include <paillier.hpp>
+
+int main()
+{
+    using namespace paillier::impl;
+
+    const auto [priv, pub] = key::gen(1024);
+    const PublicContext ctx{pub};
+
+    for (const unsigned size : {0U, 1U, 5U, 2000U})
+    {
+        std::vector<PlainText> plains{};
+        mpz_class expected{0U};
+
+        for (unsigned i = 0; i < size; ++i)
+        {
+            plains.emplace_back(i * 31U);
+            expected += i * 31U;
+        }
+
+        if (sum(encrypt_batch(plains, ctx), ctx).decrypt(priv).text != expected)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}